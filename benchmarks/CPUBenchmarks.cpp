@@ -0,0 +1,208 @@
+#include <benchmark/benchmark.h>
+
+#include "Constants.h"
+#include "Instruction.h"
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Interconnect.h"
+
+#include <memory>
+#include <vector>
+
+using namespace ePugStation;
+
+namespace
+{
+    constexpr uint32_t PROGRAM_START = BIOS_ROM_LOGICAL;
+    constexpr uint32_t EXCEPTION_HANDLER = 0x80000080;
+    constexpr int64_t INSTRUCTIONS_PER_ITERATION = 10000;
+
+    // Registers
+    constexpr uint32_t ZERO = 0;
+    constexpr uint32_t T0 = 8, T1 = 9, T2 = 10, T3 = 11, T4 = 12, T5 = 13, T6 = 14, T7 = 15;
+    constexpr uint32_t S0 = 16, S1 = 17, S2 = 18;
+    constexpr uint32_t K0 = 26;
+    constexpr uint32_t RA = 31;
+
+    constexpr uint32_t NOP = 0;
+
+    uint32_t special(SecondaryOp op, uint32_t d, uint32_t s, uint32_t t, uint32_t h = 0)
+    {
+        return (s << 21) | (t << 16) | (d << 11) | (h << 6) | static_cast<uint32_t>(op);
+    }
+
+    uint32_t immediate(PrimaryOp op, uint32_t t, uint32_t s, int16_t imm)
+    {
+        return (static_cast<uint32_t>(op) << 26) | (s << 21) | (t << 16) | static_cast<uint16_t>(imm);
+    }
+
+    // Offset in instructions, relative to the delay slot
+    uint32_t branch(PrimaryOp op, uint32_t s, uint32_t t, int16_t offset)
+    {
+        return immediate(op, t, s, offset);
+    }
+
+    uint32_t jump(PrimaryOp op, uint32_t index)
+    {
+        return (static_cast<uint32_t>(op) << 26) | (((PROGRAM_START + index * 4) >> 2) & 0x03ffffff);
+    }
+
+    struct Program
+    {
+        std::vector<uint32_t> code;
+        std::vector<uint32_t> exceptionHandler;
+    };
+
+    // Register to register arithmetic and logic
+    Program aluProgram()
+    {
+        return { {
+            immediate(PrimaryOp::opLUI, T0, ZERO, 0x1234),
+            immediate(PrimaryOp::opORI, T0, T0, 0x5678),
+            immediate(PrimaryOp::opADDIU, T1, ZERO, 7),
+            // loop (3)
+            special(SecondaryOp::opADDU, T2, T0, T1),
+            special(SecondaryOp::opSUBU, T3, T2, T1),
+            special(SecondaryOp::opAND, T4, T2, T3),
+            special(SecondaryOp::opOR, T5, T4, T0),
+            special(SecondaryOp::opXOR, T6, T5, T1),
+            special(SecondaryOp::opSLL, T7, ZERO, T6, 3),
+            special(SecondaryOp::opSRL, T7, ZERO, T7, 1),
+            special(SecondaryOp::opSRA, T7, ZERO, T7, 2),
+            special(SecondaryOp::opSLT, S0, T1, T0),
+            special(SecondaryOp::opSLTU, S1, T0, T1),
+            special(SecondaryOp::opMULT, ZERO, T0, T1),
+            special(SecondaryOp::opMFLO, S2, ZERO, ZERO),
+            immediate(PrimaryOp::opADDIU, T1, T1, 1),
+            jump(PrimaryOp::opJ, 3),
+            NOP
+        }, {} };
+    }
+
+    // Word, halfword and byte accesses to RAM
+    Program loadStoreProgram()
+    {
+        return { {
+            immediate(PrimaryOp::opLUI, S0, ZERO, static_cast<int16_t>(0x8001)),
+            immediate(PrimaryOp::opADDIU, T1, ZERO, 0),
+            // loop (2)
+            immediate(PrimaryOp::opSW, T1, S0, 0),
+            immediate(PrimaryOp::opSW, T1, S0, 4),
+            immediate(PrimaryOp::opLW, T2, S0, 0),
+            immediate(PrimaryOp::opLW, T3, S0, 4),
+            immediate(PrimaryOp::opSH, T1, S0, 8),
+            immediate(PrimaryOp::opLHU, T4, S0, 8),
+            immediate(PrimaryOp::opSB, T1, S0, 12),
+            immediate(PrimaryOp::opLBU, T5, S0, 12),
+            immediate(PrimaryOp::opADDIU, T1, T1, 1),
+            jump(PrimaryOp::opJ, 2),
+            NOP
+        }, {} };
+    }
+
+    // Taken and not taken branches, jumps and calls
+    Program branchProgram()
+    {
+        return { {
+            immediate(PrimaryOp::opADDIU, T0, ZERO, 0),
+            // loop (1)
+            immediate(PrimaryOp::opADDIU, T0, T0, 1),
+            immediate(PrimaryOp::opANDI, T1, T0, 1),
+            branch(PrimaryOp::opBEQ, T1, ZERO, 2),
+            NOP,
+            immediate(PrimaryOp::opADDIU, T2, T2, 1),
+            branch(PrimaryOp::opBNE, T1, ZERO, 2),
+            NOP,
+            immediate(PrimaryOp::opADDIU, T3, T3, 1),
+            branch(PrimaryOp::BranchOp, T0, 0b00001, 1), // BGEZ
+            NOP,
+            branch(PrimaryOp::opBLEZ, T0, ZERO, -11),
+            NOP,
+            jump(PrimaryOp::opJAL, 17),
+            NOP,
+            jump(PrimaryOp::opJ, 1),
+            NOP,
+            // sub (17)
+            special(SecondaryOp::opJR, ZERO, RA, ZERO),
+            NOP
+        }, {} };
+    }
+
+    // SYSCALL on every loop, handler returns after the faulting instruction
+    Program exceptionProgram()
+    {
+        return { {
+            // loop (0)
+            special(SecondaryOp::opSYSCALL, ZERO, ZERO, ZERO),
+            immediate(PrimaryOp::opADDIU, T0, T0, 1),
+            jump(PrimaryOp::opJ, 0),
+            NOP
+        }, {
+            (static_cast<uint32_t>(PrimaryOp::opCop0) << 26) | (K0 << 16) | (14 << 11), // MFC0 k0, EPC
+            NOP,
+            immediate(PrimaryOp::opADDIU, K0, K0, 4),
+            special(SecondaryOp::opJR, ZERO, K0, ZERO),
+            0x42000010 // RFE
+        } };
+    }
+
+    // Items processed are executed instructions, so items_per_second is the CPU throughput
+    void runProgram(benchmark::State& state, const Program& program)
+    {
+        // Headless, the program is the whole BIOS
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords(program.code));
+        for (size_t i = 0; i < program.exceptionHandler.size(); ++i)
+        {
+            interconnect->store32(EXCEPTION_HANDLER + static_cast<uint32_t>(i * 4), program.exceptionHandler[i]);
+        }
+
+        CPU cpu(interconnect.get());
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < INSTRUCTIONS_PER_ITERATION; ++i)
+            {
+                cpu.runNextInstruction();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * INSTRUCTIONS_PER_ITERATION);
+    }
+
+    // Same ALU loop, every instruction recorded in the trace ring
+    void runTracedProgram(benchmark::State& state)
+    {
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords(aluProgram().code));
+        CPU cpu(interconnect.get());
+        TraceRecorder trace;
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < INSTRUCTIONS_PER_ITERATION; ++i)
+            {
+                cpu.runNextInstruction<true>(&trace);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * INSTRUCTIONS_PER_ITERATION);
+    }
+
+    // Same ALU loop, every instruction seen by the profiler with its default sampling interval
+    void runProfiledProgram(benchmark::State& state)
+    {
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords(aluProgram().code));
+        CPU cpu(interconnect.get());
+        Profiler profiler;
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < INSTRUCTIONS_PER_ITERATION; ++i)
+            {
+                cpu.runNextInstruction<false, true>(nullptr, &profiler);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * INSTRUCTIONS_PER_ITERATION);
+    }
+}
+
+BENCHMARK_CAPTURE(runProgram, alu, aluProgram());
+BENCHMARK_CAPTURE(runProgram, loadStore, loadStoreProgram());
+BENCHMARK_CAPTURE(runProgram, branch, branchProgram());
+BENCHMARK_CAPTURE(runProgram, exception, exceptionProgram());
+BENCHMARK(runTracedProgram);
+BENCHMARK(runProfiledProgram);
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+
+#include "Constants.h"
+#include "Hash.h"
+
+#include <vector>
+
+using namespace ePugStation;
+
+namespace
+{
+    // One frame worth of RAM
+    void hashRamXXH64(benchmark::State& state)
+    {
+        std::vector<uint8_t> ram(RAM_SIZE, 0xac);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(hash64(ram.data(), ram.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(ram.size()));
+    }
+
+    void hashRamCRC32C(benchmark::State& state)
+    {
+        std::vector<uint8_t> ram(RAM_SIZE, 0xac);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(crc32c(ram.data(), ram.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(ram.size()));
+    }
+}
+
+BENCHMARK(hashRamXXH64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(hashRamCRC32C)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "SaveState.h"
+
+#include <memory>
+#include <vector>
+
+using namespace ePugStation;
+
+namespace
+{
+    void saveMachineState(benchmark::State& state)
+    {
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords({}));
+        CPU cpu(interconnect.get());
+        std::vector<uint8_t> buffer;
+
+        for (auto _ : state)
+        {
+            saveState(cpu, *interconnect, buffer);
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+    }
+
+    // Typical frame, a few dozen pages written between snapshots
+    void saveMachineDeltaState(benchmark::State& state)
+    {
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords({}));
+        CPU cpu(interconnect.get());
+        std::vector<uint8_t> buffer;
+        const auto pages = static_cast<uint32_t>(state.range(0));
+
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (uint32_t page = 0; page < pages; ++page)
+            {
+                interconnect->store32(0x80000000 + page * 0x8000, page);
+            }
+            state.ResumeTiming();
+
+            saveDeltaState(cpu, *interconnect, buffer);
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.counters["bytes"] = static_cast<double>(buffer.size());
+    }
+
+    void loadMachineState(benchmark::State& state)
+    {
+        auto interconnect = std::make_unique<Interconnect>(BiosImage::fromWords({}));
+        CPU cpu(interconnect.get());
+        std::vector<uint8_t> buffer;
+        saveState(cpu, *interconnect, buffer);
+
+        for (auto _ : state)
+        {
+            loadState(cpu, *interconnect, buffer.data(), buffer.size());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+    }
+}
+
+BENCHMARK(saveMachineState)->Unit(benchmark::kMicrosecond);
+BENCHMARK(saveMachineDeltaState)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(loadMachineState)->Unit(benchmark::kMicrosecond);
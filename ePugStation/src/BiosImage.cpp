@@ -0,0 +1,60 @@
+#include "BiosImage.h"
+#include "Hash.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ePugStation
+{
+    BiosImage::BiosImage() : m_data(nullptr) {}
+    BiosImage::~BiosImage() = default;
+
+    std::shared_ptr<const BiosImage> BiosImage::fromFile(const std::string& path)
+    {
+        auto mapping = std::make_unique<MappedFile>(path);
+
+        // Reads past the end of a mapping fault, so only full dumps are accepted
+        if (mapping->size() != BIOS_MEMORY_SIZE)
+        {
+            throw std::runtime_error("BIOS file size mismatch... got " + std::to_string(mapping->size()) + " bytes");
+        }
+
+        auto image = std::shared_ptr<BiosImage>(new BiosImage());
+        image->m_data = mapping->data();
+        image->m_mapping = std::move(mapping);
+        image->m_hash = hash64(image->m_data, BIOS_MEMORY_SIZE);
+        return image;
+    }
+
+    std::shared_ptr<const BiosImage> BiosImage::fromMemory(const uint8_t* data, size_t size)
+    {
+        if (data == nullptr || size < BIOS_MEMORY_SIZE)
+        {
+            throw std::runtime_error("BIOS image too small... got " + std::to_string(size) + " bytes");
+        }
+
+        auto image = std::shared_ptr<BiosImage>(new BiosImage());
+        image->m_data = data;
+        image->m_hash = hash64(image->m_data, BIOS_MEMORY_SIZE);
+        return image;
+    }
+
+    std::shared_ptr<const BiosImage> BiosImage::fromWords(const std::vector<uint32_t>& words)
+    {
+        if (words.size() * sizeof(uint32_t) > BIOS_MEMORY_SIZE)
+        {
+            throw std::runtime_error("Synthetic BIOS too large... got " + std::to_string(words.size()) + " words");
+        }
+
+        auto image = std::shared_ptr<BiosImage>(new BiosImage());
+        image->m_storage.resize(BIOS_MEMORY_SIZE, 0);
+        if (!words.empty())
+        {
+            std::memcpy(image->m_storage.data(), words.data(), words.size() * sizeof(uint32_t));
+        }
+        image->m_data = image->m_storage.data();
+        image->m_hash = hash64(image->m_data, BIOS_MEMORY_SIZE);
+        return image;
+    }
+}
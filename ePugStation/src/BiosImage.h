@@ -0,0 +1,48 @@
+#ifndef E_PUG_STATION_BIOS_IMAGE
+#define E_PUG_STATION_BIOS_IMAGE
+
+#include "Constants.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    class MappedFile;
+
+    // Read only BIOS ROM content. Always exposes BIOS_MEMORY_SIZE bytes so the
+    // interconnect can index it without bound checks. Images are immutable and
+    // can be shared between any number of interconnects.
+    class BiosImage
+    {
+    public:
+        ~BiosImage();
+
+        // Maps a BIOS dump read only, the pages are shared with every process mapping the same file
+        static std::shared_ptr<const BiosImage> fromFile(const std::string& path);
+
+        // Borrows "data", which must stay alive as long as the image and hold BIOS_MEMORY_SIZE bytes
+        static std::shared_ptr<const BiosImage> fromMemory(const uint8_t* data, size_t size);
+
+        // Synthetic ROM, "words" are placed at the reset vector and the rest is filled with 0
+        static std::shared_ptr<const BiosImage> fromWords(const std::vector<uint32_t>& words);
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return BIOS_MEMORY_SIZE; }
+
+        // hash64 of the content, computed once, keys the caches of decoded BIOS code
+        uint64_t getHash() const { return m_hash; }
+
+    private:
+        BiosImage();
+
+        std::unique_ptr<MappedFile> m_mapping;
+        std::vector<uint8_t> m_storage; // Empty when borrowing or mapping
+        const uint8_t* m_data;
+        uint64_t m_hash = 0;
+    };
+}
+#endif
@@ -1,8 +1,10 @@
 #include "CPU.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include "OpUtilities.h"
 #include "Utils.h"
 
-#include <iostream>
+#include <algorithm>
 #include <map>
 #include <functional>
 #include <stdexcept>
@@ -26,9 +28,38 @@ namespace ePugStation
       m_registers[0] = 0; // Constant R0
    }
 
-   void CPU::runNextInstruction()
+   template<bool IS_TRACING, bool IS_PROFILING>
+   void CPU::runNextInstruction(TraceRecorder* trace, Profiler* profiler)
    {
-      m_instruction = Instruction(load32(m_ip));
+      // Fetches stopped by an interrupt or an address error did not execute, they are neither traced nor profiled
+      if (!executeNextInstruction())
+      {
+         return;
+      }
+      if constexpr (IS_TRACING)
+      {
+         TraceRegisters registers;
+         std::copy(m_registers.begin(), m_registers.end(), registers.begin());
+         registers[TRACE_HI] = m_HI;
+         registers[TRACE_LO] = m_LO;
+         trace->record(m_currentIp, m_instruction.value, registers);
+      }
+      if constexpr (IS_PROFILING)
+      {
+         profiler->onInstruction(m_currentIp, m_instruction.value);
+      }
+   }
+
+   template void CPU::runNextInstruction<false, false>(TraceRecorder* trace, Profiler* profiler);
+   template void CPU::runNextInstruction<true, false>(TraceRecorder* trace, Profiler* profiler);
+   template void CPU::runNextInstruction<false, true>(TraceRecorder* trace, Profiler* profiler);
+   template void CPU::runNextInstruction<true, true>(TraceRecorder* trace, Profiler* profiler);
+
+   bool CPU::executeNextInstruction()
+   {
+      // BIOS code comes predecoded from the shared cache
+      Opcode opcode;
+      m_instruction = Instruction(m_interconnect->fetch32(m_ip, opcode));
 
       m_delaySlot = m_isBranching;
       m_isBranching = false;
@@ -39,15 +70,77 @@ namespace ePugStation
       if (!checkIfAlignedBy<ALIGNED_FOR_32_BITS>(m_currentIp))
       {
          exception(CPUException::LoadAddressError);
-         return;
+         return false;
+      }
+
+      m_cop0.setHardwareInterrupt(m_interconnect->isInterruptPending());
+      if (m_cop0.isInterruptPending())
+      {
+         exception(CPUException::Interrupt);
+         return false;
       }
 
       // Point IP to next instruction
       m_nextIp += 4;
       setReg(m_loadPair);
       m_loadPair = std::make_pair(0, 0);
-      decodeAndExecuteCurrentOp();
+      execute(opcode);
       m_registers = m_outputRegisters;
+      return true;
+   }
+
+   void CPU::jumpTo(uint32_t address)
+   {
+      m_ip = address;
+      m_nextIp = address + 4;
+      m_isBranching = false;
+      m_delaySlot = false;
+      m_loadPair = std::make_pair(0, 0);
+   }
+
+   void CPU::setRegister(uint32_t index, uint32_t value)
+   {
+      if (index != 0)
+      {
+         m_registers[index] = value;
+         m_outputRegisters[index] = value;
+      }
+   }
+
+   void CPU::saveState(SaveStateWriter& writer) const
+   {
+      writer.write(m_instruction.value);
+      writer.write(m_ip);
+      writer.write(m_currentIp);
+      writer.write(m_nextIp);
+      writer.write(m_HI);
+      writer.write(m_LO);
+      writer.write(m_isBranching);
+      writer.write(m_delaySlot);
+      writer.write(m_registers);
+      writer.write(m_outputRegisters);
+      writer.write(m_loadPair.first);
+      writer.write(m_loadPair.second);
+      m_cop0.saveState(writer);
+      m_gte.saveState(writer);
+   }
+
+   void CPU::loadState(SaveStateReader& reader)
+   {
+      m_instruction = Instruction(reader.read<uint32_t>());
+      m_ip = reader.read<uint32_t>();
+      m_currentIp = reader.read<uint32_t>();
+      m_nextIp = reader.read<uint32_t>();
+      m_HI = reader.read<uint32_t>();
+      m_LO = reader.read<uint32_t>();
+      m_isBranching = reader.read<bool>();
+      m_delaySlot = reader.read<bool>();
+      m_registers = reader.read<std::array<uint32_t, CPU_REGISTERS>>();
+      m_outputRegisters = reader.read<std::array<uint32_t, CPU_REGISTERS>>();
+      m_loadPair.first = reader.read<uint32_t>();
+      m_loadPair.second = reader.read<uint32_t>();
+      m_cop0.loadState(reader);
+      m_gte.loadState(reader);
    }
 
    uint8_t CPU::load8(uint32_t address) const
@@ -80,100 +173,85 @@ namespace ePugStation
       m_interconnect->store32(address, value);
    }
 
-   void CPU::decodeAndExecuteCurrentOp()
-   {
-      switch (m_instruction.op.primary)
-      {
-      case PrimaryOp::SubOp: matchSubOp(); break;
-      case PrimaryOp::BranchOp: matchSubBranchOp(); break;
-      case PrimaryOp::opJ: opJ(); break;
-      case PrimaryOp::opJAL: opJAL(); break;
-      case PrimaryOp::opBEQ: opBEQ(); break;
-      case PrimaryOp::opBNE: opBNE(); break;
-      case PrimaryOp::opBLEZ: opBLEZ(); break;
-      case PrimaryOp::opBGTZ: opBGTZ(); break;
-      case PrimaryOp::opADDI: opADDI(); break;
-      case PrimaryOp::opADDIU: opADDIU(); break;
-      case PrimaryOp::opSLTI: opSLTI(); break;
-      case PrimaryOp::opSLTIU: opSLTIU(); break;
-      case PrimaryOp::opANDI: opANDI(); break;
-      case PrimaryOp::opORI: opORI(); break;
-      case PrimaryOp::opXORI: opXORI(); break;
-      case PrimaryOp::opCop0: opCop0(); break;
-      case PrimaryOp::opCop1: opCop1(); break;
-      case PrimaryOp::opCop2: opCop2(); break;
-      case PrimaryOp::opCop3: opCop3(); break;
-      case PrimaryOp::opLUI: opLUI(); break;
-      case PrimaryOp::opLB:opLB(); break;
-      case PrimaryOp::opLBU: opLBU(); break;
-      case PrimaryOp::opLH:opLH(); break;
-      case PrimaryOp::opLWL: opLWL(); break;
-      case PrimaryOp::opLW:opLW(); break;
-      case PrimaryOp::opLHU: opLHU(); break;
-      case PrimaryOp::opLWR: opLWR(); break;
-      case PrimaryOp::opSB:opSB(); break;
-      case PrimaryOp::opSH:opSH(); break;
-      case PrimaryOp::opSWL: opSWL(); break;
-      case PrimaryOp::opSW:opSW(); break;
-      case PrimaryOp::opSWR: opSWR(); break;
-      case PrimaryOp::opLWC0: opLWC0(); break;
-      case PrimaryOp::opLWC1: opLWC1(); break;
-      case PrimaryOp::opLWC2: opLWC2(); break;
-      case PrimaryOp::opLWC3: opLWC3(); break;
-      case PrimaryOp::opSWC0: opSWC0(); break;
-      case PrimaryOp::opSWC1: opSWC1(); break;
-      case PrimaryOp::opSWC2: opSWC2(); break;
-      case PrimaryOp::opSWC3: opSWC3(); break;
-      default:
-         throw std::runtime_error("Primary op instruction function not implemented");
-      }
-   }
-
-   void CPU::matchSubBranchOp()
+   void CPU::execute(Opcode opcode)
    {
-      switch (m_instruction.reg.t)
+      switch (opcode)
       {
-      case 0b00000: opBLTZ(); break;
-      case 0b00001: opBGEZ(); break;
-      case 0b10000: opBLTZAL(); break;
-      case 0b10001: opBGEZAL(); break;
-      default:
+      case Opcode::J: opJ(); break;
+      case Opcode::JAL: opJAL(); break;
+      case Opcode::BEQ: opBEQ(); break;
+      case Opcode::BNE: opBNE(); break;
+      case Opcode::BLEZ: opBLEZ(); break;
+      case Opcode::BGTZ: opBGTZ(); break;
+      case Opcode::ADDI: opADDI(); break;
+      case Opcode::ADDIU: opADDIU(); break;
+      case Opcode::SLTI: opSLTI(); break;
+      case Opcode::SLTIU: opSLTIU(); break;
+      case Opcode::ANDI: opANDI(); break;
+      case Opcode::ORI: opORI(); break;
+      case Opcode::XORI: opXORI(); break;
+      case Opcode::Cop0: opCop0(); break;
+      case Opcode::Cop1: opCop1(); break;
+      case Opcode::Cop2: opCop2(); break;
+      case Opcode::Cop3: opCop3(); break;
+      case Opcode::LUI: opLUI(); break;
+      case Opcode::LB: opLB(); break;
+      case Opcode::LBU: opLBU(); break;
+      case Opcode::LH: opLH(); break;
+      case Opcode::LWL: opLWL(); break;
+      case Opcode::LW: opLW(); break;
+      case Opcode::LHU: opLHU(); break;
+      case Opcode::LWR: opLWR(); break;
+      case Opcode::SB: opSB(); break;
+      case Opcode::SH: opSH(); break;
+      case Opcode::SWL: opSWL(); break;
+      case Opcode::SW: opSW(); break;
+      case Opcode::SWR: opSWR(); break;
+      case Opcode::LWC0: opLWC0(); break;
+      case Opcode::LWC1: opLWC1(); break;
+      case Opcode::LWC2: opLWC2(); break;
+      case Opcode::LWC3: opLWC3(); break;
+      case Opcode::SWC0: opSWC0(); break;
+      case Opcode::SWC1: opSWC1(); break;
+      case Opcode::SWC2: opSWC2(); break;
+      case Opcode::SWC3: opSWC3(); break;
+      case Opcode::SLL: opSLL(); break;
+      case Opcode::SRL: opSRL(); break;
+      case Opcode::SRA: opSRA(); break;
+      case Opcode::SLLV: opSLLV(); break;
+      case Opcode::SRLV: opSRLV(); break;
+      case Opcode::SRAV: opSRAV(); break;
+      case Opcode::JR: opJR(); break;
+      case Opcode::JALR: opJALR(); break;
+      case Opcode::SYSCALL: opSYSCALL(); break;
+      case Opcode::BREAK: opBREAK(); break;
+      case Opcode::MFHI: opMFHI(); break;
+      case Opcode::MTHI: opMTHI(); break;
+      case Opcode::MFLO: opMFLO(); break;
+      case Opcode::MTLO: opMTLO(); break;
+      case Opcode::MULT: opMULT(); break;
+      case Opcode::MULTU: opMULTU(); break;
+      case Opcode::DIV: opDIV(); break;
+      case Opcode::DIVU: opDIVU(); break;
+      case Opcode::ADD: opADD(); break;
+      case Opcode::ADDU: opADDU(); break;
+      case Opcode::SUB: opSUB(); break;
+      case Opcode::SUBU: opSUBU(); break;
+      case Opcode::AND: opAND(); break;
+      case Opcode::OR: opOR(); break;
+      case Opcode::XOR: opXOR(); break;
+      case Opcode::NOR: opNOR(); break;
+      case Opcode::SLT: opSLT(); break;
+      case Opcode::SLTU: opSLTU(); break;
+      case Opcode::BLTZ: opBLTZ(); break;
+      case Opcode::BGEZ: opBGEZ(); break;
+      case Opcode::BLTZAL: opBLTZAL(); break;
+      case Opcode::BGEZAL: opBGEZAL(); break;
+      case Opcode::InvalidPrimary:
+         throw std::runtime_error("Primary op instruction function not implemented");
+      case Opcode::InvalidBranchOp:
          throw std::runtime_error("Unsupported branch op with t value : " + std::to_string(m_instruction.reg.t));
-      }
-   }
-
-   void CPU::matchSubOp()
-   {
-      switch (m_instruction.op.seconday)
-      {
-      case SecondaryOp::opSLL:opSLL(); break;
-      case SecondaryOp::opSRL:opSRL(); break;
-      case SecondaryOp::opSRA:opSRA(); break;
-      case SecondaryOp::opSLLV: opSLLV(); break;
-      case SecondaryOp::opSRLV: opSRLV(); break;
-      case SecondaryOp::opSRAV: opSRAV(); break;
-      case SecondaryOp::opJR: opJR(); break;
-      case SecondaryOp::opJALR: opJALR(); break;
-      case SecondaryOp::opSYSCALL: opSYSCALL(); break;
-      case SecondaryOp::opBREAK: opBREAK(); break;
-      case SecondaryOp::opMFHI: opMFHI(); break;
-      case SecondaryOp::opMTHI: opMTHI(); break;
-      case SecondaryOp::opMFLO: opMFLO(); break;
-      case SecondaryOp::opMTLO: opMTLO(); break;
-      case SecondaryOp::opMULT: opMULT(); break;
-      case SecondaryOp::opMULTU: opMULTU(); break;
-      case SecondaryOp::opDIV: opDIV(); break;
-      case SecondaryOp::opDIVU: opDIVU(); break;
-      case SecondaryOp::opADD: opADD(); break;
-      case SecondaryOp::opADDU: opADDU(); break;
-      case SecondaryOp::opSUB: opSUB(); break;
-      case SecondaryOp::opSUBU: opSUBU(); break;
-      case SecondaryOp::opAND: opAND(); break;
-      case SecondaryOp::opOR: opOR(); break;
-      case SecondaryOp::opXOR: opXOR(); break;
-      case SecondaryOp::opNOR: opNOR(); break;
-      case SecondaryOp::opSLT: opSLT(); break;
-      case SecondaryOp::opSLTU: opSLTU();  break;
+      case Opcode::InvalidSubOp:
       default:
          throw std::runtime_error("SubOperation not implemented...");
       }
@@ -217,7 +295,22 @@ namespace ePugStation
    // GTE
    void CPU::opCop2()
    {
-      throw std::runtime_error("Unhandled GTE instruction");
+      // Bit 25 set : GTE command
+      if (m_instruction.value & (1 << 25))
+      {
+         m_gte.execute(m_instruction.value);
+         return;
+      }
+
+      switch (m_instruction.reg.s)
+      {
+      case 0b00000: opMFC2(); break;
+      case 0b00010: opCFC2(); break;
+      case 0b00100: opMTC2(); break;
+      case 0b00110: opCTC2(); break;
+      default:
+         throw std::runtime_error("Unhandled GTE opcode...");
+      }
    }
 
    void CPU::opCop3()
@@ -285,6 +378,32 @@ namespace ePugStation
       }
    }
 
+   // Move From Cop2 data register
+   void CPU::opMFC2()
+   {
+      uint32_t index = m_instruction.reg.t;
+      m_loadPair = std::make_pair(index, m_gte.getData(m_instruction.reg.d));
+   }
+
+   // Move From Cop2 control register
+   void CPU::opCFC2()
+   {
+      uint32_t index = m_instruction.reg.t;
+      m_loadPair = std::make_pair(index, m_gte.getControl(m_instruction.reg.d));
+   }
+
+   // Move To Cop2 data register
+   void CPU::opMTC2()
+   {
+      m_gte.setData(m_instruction.reg.d, m_registers[m_instruction.reg.t]);
+   }
+
+   // Move To Cop2 control register
+   void CPU::opCTC2()
+   {
+      m_gte.setControl(m_instruction.reg.d, m_registers[m_instruction.reg.t]);
+   }
+
    void CPU::opLWC0()
    {
       exception(CPUException::CoprocessorError);
@@ -295,9 +414,18 @@ namespace ePugStation
       exception(CPUException::CoprocessorError);
    }
 
+   // Load word to GTE data register
    void CPU::opLWC2()
    {
-      throw std::runtime_error("Unhandled GTE LWC2 operation...");
+      uint32_t address = m_registers[m_instruction.reg.s] + m_instruction.imm_se;
+      if (checkIfAlignedBy<ALIGNED_FOR_32_BITS>(address))
+      {
+         m_gte.setData(m_instruction.reg.t, load32(address));
+      }
+      else
+      {
+         exception(CPUException::LoadAddressError);
+      }
    }
 
    void CPU::opLWC3()
@@ -315,9 +443,18 @@ namespace ePugStation
       exception(CPUException::CoprocessorError);
    }
 
+   // Store word from GTE data register
    void CPU::opSWC2()
    {
-      throw std::runtime_error("Unhandled GTE SWC2 operation...");
+      uint32_t address = m_registers[m_instruction.reg.s] + m_instruction.imm_se;
+      if (checkIfAlignedBy<ALIGNED_FOR_32_BITS>(address))
+      {
+         store32(address, m_gte.getData(m_instruction.reg.t));
+      }
+      else
+      {
+         exception(CPUException::StoreAddressError);
+      }
    }
 
    void CPU::opSWC3()
@@ -327,7 +464,7 @@ namespace ePugStation
 
    void CPU::opIllegal()
    {
-      std::cout << "Illegal instruction...\n";
+      E_PUG_STATION_LOG(Error, CPU, "Illegal instruction 0x%08x at 0x%08x", m_instruction.value, m_currentIp);
       exception(CPUException::IllegalInstruction);
    }
 
@@ -912,6 +1049,7 @@ namespace ePugStation
 
    void CPU::exception(CPUException exception)
    {
+      countMetric(Metric::Exceptions);
       uint32_t handler = m_cop0.isBootExceptionVectorsInROM() ? 0xbfc00180 : 0x80000080;
 
       // Update Interrupt and Kernel/User mode bits
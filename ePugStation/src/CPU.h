@@ -4,8 +4,12 @@
 #include "Constants.h"
 #include "Instruction.h"
 #include "Cop0.h"
+#include "GTE.h"
 #include "Interconnect.h"
 #include "CPUExceptions.h"
+#include "Profiler.h"
+#include "SaveState.h"
+#include "Trace.h"
 
 #include <cstdint>
 #include <array>
@@ -20,10 +24,24 @@ namespace ePugStation
       CPU(Interconnect* interconnect);
       ~CPU() = default;
 
-      void runNextInstruction();
+      // Tracing and profiling are chosen at compile time, the default instantiation has no instrumentation code at all
+      template<bool IS_TRACING = false, bool IS_PROFILING = false>
+      void runNextInstruction(TraceRecorder* trace = nullptr, Profiler* profiler = nullptr);
+
+      void saveState(SaveStateWriter& writer) const;
+      void loadState(SaveStateReader& reader);
+
+      // Address of the next instruction fetched
+      uint32_t getIp() const { return m_ip; }
+      uint32_t getRegister(uint32_t index) const { return m_registers[index]; }
+
+      // For loaders, between two instructions : drops any pending branch or load
+      void jumpTo(uint32_t address);
+      void setRegister(uint32_t index, uint32_t value);
    private:
       Interconnect* m_interconnect;
       Cop0 m_cop0;
+      GTE m_gte;
       Instruction m_instruction;
 
       uint32_t m_ip;
@@ -40,10 +58,9 @@ namespace ePugStation
       std::array<uint32_t, CPU_REGISTERS> m_outputRegisters;
       std::pair<uint32_t, uint32_t> m_loadPair;
 
-      void decodeAndExecuteCurrentOp();
-
-      void matchSubOp();
-      void matchSubBranchOp();
+      // False when an exception was taken before the instruction executed
+      bool executeNextInstruction();
+      void execute(Opcode opcode);
 
       void setReg(uint32_t index, uint32_t value);
       void setReg(std::pair<uint32_t, uint32_t> setRegPair);
@@ -158,6 +175,10 @@ namespace ePugStation
       void opCop3();
       void opMFC();
       void opMTC();
+      void opMFC2();
+      void opCFC2();
+      void opMTC2();
+      void opCTC2();
       void opRFE();
       void opLWC0();
       void opLWC1();
@@ -6,6 +6,7 @@ namespace ePugStation
     // TODO: Fill these with complete list
     enum class CPUException
     {
+        Interrupt = 0x0,
         LoadAddressError = 0x4,
         StoreAddressError = 0x5,
         SysCall = 0x8, // Syscall operation
@@ -0,0 +1,179 @@
+#include "CodeCache.h"
+#include "BiosImage.h"
+#include "Hash.h"
+#include "Logger.h"
+#include "SaveState.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    using namespace ePugStation;
+
+    // Only taken when an interconnect is created, never while running
+    std::mutex g_decodedBiosMutex;
+    std::unordered_map<uint64_t, std::weak_ptr<const DecodedCode>> g_decodedBios;
+    std::string g_cacheDirectory;
+
+    std::string getCachePath(uint64_t hash)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016" PRIx64 ".epcc", hash);
+        return (std::filesystem::path(g_cacheDirectory) / name).string();
+    }
+}
+
+namespace ePugStation
+{
+    DecodedCode::DecodedCode(const uint8_t* code, size_t size, uint64_t hash)
+        : m_hash(hash),
+          m_wordCount(size / sizeof(uint32_t)),
+          m_storage(m_wordCount)
+    {
+        for (size_t index = 0; index < m_wordCount; ++index)
+        {
+            uint32_t word;
+            std::memcpy(&word, code + index * sizeof(uint32_t), sizeof(word));
+            m_storage[index] = decodeOpcode(word);
+        }
+        m_opcodes = m_storage.data();
+    }
+
+    std::shared_ptr<const DecodedCode> DecodedCode::load(const std::string& path, uint64_t hash, size_t size)
+    {
+        if (!std::filesystem::exists(path))
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            auto mapping = std::make_unique<MappedFile>(path);
+            SaveStateReader reader(mapping->data(), mapping->size());
+            if (reader.read<uint32_t>() != CODE_CACHE_MAGIC || reader.read<uint32_t>() != CODE_CACHE_VERSION)
+            {
+                throw std::runtime_error("not a code cache of this version");
+            }
+            if (reader.read<uint32_t>() != OPCODE_TABLE_VERSION || reader.read<uint32_t>() != OPCODE_COUNT)
+            {
+                throw std::runtime_error("saved by another decoder");
+            }
+            if (reader.read<uint64_t>() != hash)
+            {
+                throw std::runtime_error("saved for other content");
+            }
+            uint64_t wordCount = reader.read<uint64_t>();
+            uint64_t tableHash = reader.read<uint64_t>();
+            if (wordCount != size / sizeof(uint32_t))
+            {
+                throw std::runtime_error("size mismatch");
+            }
+            const uint8_t* table = reader.view(static_cast<size_t>(wordCount) * sizeof(Opcode));
+            if (!reader.isAtEnd() || hash64(table, static_cast<size_t>(wordCount) * sizeof(Opcode)) != tableHash)
+            {
+                throw std::runtime_error("damaged");
+            }
+
+            auto decoded = std::shared_ptr<DecodedCode>(new DecodedCode());
+            decoded->m_hash = hash;
+            decoded->m_wordCount = static_cast<size_t>(wordCount);
+            decoded->m_opcodes = reinterpret_cast<const Opcode*>(table);
+            decoded->m_mapping = std::move(mapping);
+            return decoded;
+        }
+        catch (const std::exception& exception)
+        {
+            E_PUG_STATION_LOG(Warning, CPU, "Ignoring code cache %s : %s", path.c_str(), exception.what());
+            return nullptr;
+        }
+    }
+
+    void DecodedCode::save(const std::string& path) const
+    {
+        size_t tableSize = m_wordCount * sizeof(Opcode);
+        std::vector<uint8_t> buffer;
+        SaveStateWriter writer(buffer);
+        writer.write(CODE_CACHE_MAGIC);
+        writer.write(CODE_CACHE_VERSION);
+        writer.write(OPCODE_TABLE_VERSION);
+        writer.write(static_cast<uint32_t>(OPCODE_COUNT));
+        writer.write(m_hash);
+        writer.write(static_cast<uint64_t>(m_wordCount));
+        writer.write(hash64(m_opcodes, tableSize));
+        writer.writeBlock(m_opcodes, tableSize);
+
+        std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary);
+            if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size())))
+            {
+                throw std::runtime_error("Could not write code cache : " + temporaryPath);
+            }
+        }
+        // Replaces a stale cache on every platform, std::rename fails on Windows
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            throw std::runtime_error("Could not replace code cache : " + path + " (" + error.message() + ")");
+        }
+    }
+
+    void setCodeCacheDirectory(const std::string& directory)
+    {
+        std::lock_guard<std::mutex> lock(g_decodedBiosMutex);
+        g_cacheDirectory = directory;
+    }
+
+    std::shared_ptr<const DecodedCode> getDecodedBios(const BiosImage& bios)
+    {
+        std::lock_guard<std::mutex> lock(g_decodedBiosMutex);
+        std::weak_ptr<const DecodedCode>& entry = g_decodedBios[bios.getHash()];
+        if (auto decoded = entry.lock())
+        {
+            return decoded;
+        }
+
+        // Drops the BIOSes no instance runs anymore
+        for (auto it = g_decodedBios.begin(); it != g_decodedBios.end();)
+        {
+            it = it->second.expired() && &it->second != &entry ? g_decodedBios.erase(it) : std::next(it);
+        }
+
+        std::shared_ptr<const DecodedCode> decoded;
+        std::string path = g_cacheDirectory.empty() ? std::string() : getCachePath(bios.getHash());
+        if (!path.empty())
+        {
+            decoded = DecodedCode::load(path, bios.getHash(), bios.size());
+        }
+        if (!decoded)
+        {
+            auto fresh = std::make_shared<const DecodedCode>(bios.data(), bios.size(), bios.getHash());
+            E_PUG_STATION_LOG(Debug, CPU, "Decoded BIOS %016llx", static_cast<unsigned long long>(bios.getHash()));
+            if (!path.empty())
+            {
+                // A cache that cannot be written only costs the next startup
+                try
+                {
+                    std::filesystem::create_directories(g_cacheDirectory);
+                    fresh->save(path);
+                }
+                catch (const std::exception& exception)
+                {
+                    E_PUG_STATION_LOG(Warning, CPU, "%s", exception.what());
+                }
+            }
+            decoded = fresh;
+        }
+        entry = decoded;
+        return decoded;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef E_PUG_STATION_CODE_CACHE
+#define E_PUG_STATION_CODE_CACHE
+
+#include "Instruction.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    class BiosImage;
+
+    // Layout : magic, version, opcode table version and count, content hash, word count, table hash,
+    // then one Opcode per code word. Files saved for other content, by another decoder or damaged are
+    // detected on load and ignored.
+    constexpr uint32_t CODE_CACHE_MAGIC = 0x43435045; // "EPCC"
+    constexpr uint32_t CODE_CACHE_VERSION = 1;
+
+    // Opcode of every word of a read only code image, decoded once. Immutable after construction, so
+    // any number of CPUs read it concurrently without locking.
+    class DecodedCode
+    {
+    public:
+        DecodedCode(const uint8_t* code, size_t size, uint64_t hash);
+
+        DecodedCode(const DecodedCode&) = delete;
+        DecodedCode& operator=(const DecodedCode&) = delete;
+
+        // Maps a file saved for content "hash" of "size" bytes, the table is used in place.
+        // nullptr when the file is missing or does not match.
+        static std::shared_ptr<const DecodedCode> load(const std::string& path, uint64_t hash, size_t size);
+
+        // Written to a temporary file renamed over "path", so readers never map a partial file
+        void save(const std::string& path) const;
+
+        uint64_t getHash() const { return m_hash; }
+        size_t size() const { return m_wordCount * sizeof(uint32_t); }
+        bool isMapped() const { return m_mapping != nullptr; }
+
+        // "offset" in bytes, word aligned
+        Opcode getOpcode(uint32_t offset) const { return m_opcodes[offset >> 2]; }
+
+    private:
+        DecodedCode() = default;
+
+        uint64_t m_hash = 0;
+        size_t m_wordCount = 0;
+        const Opcode* m_opcodes = nullptr; // In m_storage, or in m_mapping when loaded
+        std::vector<Opcode> m_storage;
+        std::unique_ptr<MappedFile> m_mapping;
+    };
+
+    // Empty by default, decodings then only live in memory. Otherwise BIOS decodings are loaded from
+    // "<directory>/<hash>.epcc", and saved there when missing or stale.
+    void setCodeCacheDirectory(const std::string& directory);
+
+    // Process wide and keyed by the BIOS hash : instances running the same BIOS share one decoding,
+    // even from images loaded separately. Kept alive as long as one instance uses it.
+    std::shared_ptr<const DecodedCode> getDecodedBios(const BiosImage& bios);
+}
+#endif
@@ -37,6 +37,19 @@ namespace ePugStation
         m_cause.bit.BD = branchDelayBit;
     }
 
+    void Cop0::setHardwareInterrupt(bool isPending)
+    {
+        // Interrupt controller is wired to IP bit 2 (cause bit 10)
+        if (isPending)
+        {
+            m_cause.bit.ip |= 0x4;
+        }
+        else
+        {
+            m_cause.bit.ip &= ~0x4;
+        }
+    }
+
     bool Cop0::isCacheIsolated() const
     {
         return m_sr.bit.Isc == 1;
@@ -47,6 +60,11 @@ namespace ePugStation
         return m_sr.bit.BEV == 1;
     }
 
+    bool Cop0::isInterruptPending() const
+    {
+        return m_sr.bit.IEc && (m_sr.bit.Im & m_cause.bit.ip) != 0;
+    }
+
     void Cop0::updateExceptionCode(CPUException cpuException)
     {
         m_cause.bit.excode = static_cast<uint8_t>(cpuException);
@@ -58,6 +76,9 @@ namespace ePugStation
         m_sr.bit.KUo = m_sr.bit.KUp;
         m_sr.bit.IEp = m_sr.bit.IEc;
         m_sr.bit.KUp = m_sr.bit.KUc;
+        // Handlers start in kernel mode with interrupts disabled
+        m_sr.bit.IEc = 0;
+        m_sr.bit.KUc = 0;
     }
 
     void Cop0::updateNewInterupts()
@@ -67,4 +88,18 @@ namespace ePugStation
         m_sr.bit.IEp = m_sr.bit.IEo;
         m_sr.bit.KUp = m_sr.bit.KUo;
     }
+
+    void Cop0::saveState(SaveStateWriter& writer) const
+    {
+        writer.write(m_sr.value);
+        writer.write(m_cause.value);
+        writer.write(m_epc);
+    }
+
+    void Cop0::loadState(SaveStateReader& reader)
+    {
+        m_sr.value = reader.read<uint32_t>();
+        m_cause.value = reader.read<uint32_t>();
+        m_epc = reader.read<uint32_t>();
+    }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include "CPUExceptions.h"
+#include "SaveState.h"
 
 namespace ePugStation
 {
@@ -72,15 +73,20 @@ namespace ePugStation
         void setCause(uint32_t value);
         void setEpc(uint32_t value);
         void setBranchDelayBit(uint32_t branchDelayBit);
+        void setHardwareInterrupt(bool isPending);
 
         bool isCacheIsolated() const;
         bool isBootExceptionVectorsInROM() const;
+        bool isInterruptPending() const;
 
         void updateOldInterupts();
         void updateNewInterupts();
 
         void updateExceptionCode(CPUException cpuException);
 
+        void saveState(SaveStateWriter& writer) const;
+        void loadState(SaveStateReader& reader);
+
     private:
         // TODO: Fill with other registers ?
         Cop0_SR m_sr;       // Reg 12 : System status register (R/W)
@@ -0,0 +1,68 @@
+#include "DMA.h"
+
+namespace
+{
+    // Bits 0-5 and 15-23 are R/W, 24-30 are acknowledged by writing 1, 31 is read only
+    constexpr uint32_t DICR_RW_MASK = 0x00ff803f;
+    constexpr uint32_t DICR_FLAGS_MASK = 0x7f000000;
+}
+
+namespace ePugStation
+{
+    bool DMA::setInterrupt(uint32_t value)
+    {
+        uint32_t flags = (m_interrupt.value & DICR_FLAGS_MASK) & ~(value & DICR_FLAGS_MASK);
+        uint32_t masterFlag = m_interrupt.value & 0x80000000;
+        m_interrupt.value = (value & DICR_RW_MASK) | flags | masterFlag;
+        return updateMasterFlag();
+    }
+
+    bool DMA::finalizeCopy(uint32_t index)
+    {
+        m_channels[index].control.bit.enable = false;
+        m_channels[index].control.bit.startTrigger = StartTrigger::Normal;
+
+        // Flag is only set when the channel IRQ is enabled
+        if (m_interrupt.bit.iRQEnable & (1 << index))
+        {
+            m_interrupt.bit.iRQFlags |= (1 << index);
+        }
+        return updateMasterFlag();
+    }
+
+    bool DMA::updateMasterFlag()
+    {
+        bool previous = m_interrupt.bit.iRQMasterFlag;
+        bool channelIRQ = m_interrupt.bit.iRQMasterEnable && (m_interrupt.bit.iRQEnable & m_interrupt.bit.iRQFlags) != 0;
+        bool current = m_interrupt.bit.forceIRQ || channelIRQ;
+
+        m_interrupt.bit.iRQMasterFlag = current;
+
+        // IRQ3 is edge triggered on master flag
+        return !previous && current;
+    }
+
+    void DMA::saveState(SaveStateWriter& writer) const
+    {
+        writer.write(m_control);
+        writer.write(m_interrupt.value);
+        for (const DMAChannel& channel : m_channels)
+        {
+            writer.write(channel.baseAddress);
+            writer.write(channel.control.value);
+            writer.write(channel.blockChannel.value);
+        }
+    }
+
+    void DMA::loadState(SaveStateReader& reader)
+    {
+        m_control = reader.read<uint32_t>();
+        m_interrupt.value = reader.read<uint32_t>();
+        for (DMAChannel& channel : m_channels)
+        {
+            channel.baseAddress = reader.read<uint32_t>();
+            channel.control.value = reader.read<uint32_t>();
+            channel.blockChannel.value = reader.read<uint32_t>();
+        }
+    }
+}
\ No newline at end of file
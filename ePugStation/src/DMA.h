@@ -2,6 +2,7 @@
 #define E_PUG_STATION_DMA
 
 #include "Constants.h"
+#include "SaveState.h"
 #include <stdexcept>
 
 namespace ePugStation
@@ -59,7 +60,8 @@ namespace ePugStation
         {
             uint32_t value;
             struct {
-                unsigned unused : 15;
+                unsigned unknown : 6;
+                unsigned unused : 9;
                 unsigned forceIRQ : 1;
                 unsigned iRQEnable : 7;
                 unsigned iRQMasterEnable : 1;
@@ -130,14 +132,15 @@ namespace ePugStation
     class DMA
     {
     public:
-        DMA() : m_control(DMA_RESET) {};
+        DMA() : m_control(DMA_RESET), m_interrupt(0) {};
         ~DMA() = default;
 
         uint32_t getControl() const { return m_control; }
         void setControl(uint32_t value) { m_control = value; }
 
         uint32_t getInterrupt() const { return m_interrupt.value; }
-        void setInterrupt(uint32_t value) { m_interrupt.value = value; }
+        // Returns true when the write raises the DMA IRQ (master flag 0 -> 1)
+        bool setInterrupt(uint32_t value);
 
         uint32_t getChannelControl(uint32_t index) const { return m_channels[index].control.value; }
         void setChannelControl(uint32_t index, uint32_t value) { m_channels[index].control.value = value; }
@@ -158,15 +161,17 @@ namespace ePugStation
             return trigger && m_channels[index].control.bit.enable;
         }
 
-        void finalizeCopy(uint32_t index)
-        {
-            m_channels[index].control.bit.enable = false;
-            m_channels[index].control.bit.startTrigger = StartTrigger::Normal;
-        }
+        // Returns true when the end of transfer raises the DMA IRQ (master flag 0 -> 1)
+        bool finalizeCopy(uint32_t index);
 
         DMAChannel getChannel(uint32_t index) const { return m_channels[index]; };
 
+        void saveState(SaveStateWriter& writer) const;
+        void loadState(SaveStateReader& reader);
+
     private:
+        bool updateMasterFlag();
+
         uint32_t m_control;
         DMAInterrupt m_interrupt;
         DMAChannel m_channels[7];
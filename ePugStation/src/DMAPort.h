@@ -0,0 +1,37 @@
+#ifndef E_PUG_STATION_DMA_PORT
+#define E_PUG_STATION_DMA_PORT
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ePugStation
+{
+    // DMA channel index, see http://problemkaputt.de/psx-spx.htm#dmachannels
+    enum class DMAChannelPort : unsigned
+    {
+        MDECin = 0,
+        MDECout = 1,
+        GPU = 2,
+        CDROM = 3,
+        SPU = 4,
+        PIO = 5,
+        OTC = 6
+    };
+
+    constexpr uint32_t DMA_CHANNEL_COUNT = 7;
+
+    // Device side of a DMA channel. Words are streamed in contiguous chunks
+    // so devices can consume them in bulk instead of one call per word.
+    class DMAPort
+    {
+    public:
+        virtual ~DMAPort() = default;
+
+        // Device -> RAM : fill "count" words
+        virtual void readWords(uint32_t* words, size_t count) = 0;
+
+        // RAM -> device : consume "count" words
+        virtual void writeWords(const uint32_t* words, size_t count) = 0;
+    };
+}
+#endif
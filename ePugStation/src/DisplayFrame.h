@@ -0,0 +1,25 @@
+#ifndef E_PUG_STATION_DISPLAY_FRAME
+#define E_PUG_STATION_DISPLAY_FRAME
+
+#include <cstdint>
+#include <vector>
+
+namespace ePugStation
+{
+   // Rendered output of one emulated frame, handed from the emulation thread to the presentation one
+   struct DisplayFrame
+   {
+      static constexpr uint32_t WIDTH = 1024;
+      static constexpr uint32_t HEIGHT = 512;
+
+      std::vector<uint8_t> pixels = std::vector<uint8_t>(WIDTH * HEIGHT * 4); // RGBA8, bottom row first
+      uint64_t number = 0;
+
+      // Pacing of the emulation thread when the frame was produced
+      double speed = 0.0;
+      double frameRate = 0.0;
+      bool isThrottled = true;
+   };
+}
+
+#endif
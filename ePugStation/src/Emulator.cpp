@@ -0,0 +1,82 @@
+#include "Emulator.h"
+#include "Metrics.h"
+#include "Replay.h"
+#include "SaveState.h"
+
+namespace ePugStation
+{
+    Emulator::Emulator(std::shared_ptr<const BiosImage> bios, std::unique_ptr<GPU> gpu)
+        : m_interconnect(std::make_unique<Interconnect>(std::move(bios), std::move(gpu))),
+          m_cpu(m_interconnect.get())
+    {
+    }
+
+    void Emulator::runFrame(const FrameInput& input, TraceRecorder* trace, Profiler* profiler)
+    {
+        runFrame(input, getInstructionsPerFrame(), trace, profiler);
+    }
+
+    void Emulator::runFrame(const FrameInput& input, uint32_t instructions, TraceRecorder* trace, Profiler* profiler)
+    {
+        if (m_pendingExecutable)
+        {
+            instructions -= bootUntilShell(instructions);
+        }
+        ePugStation::runFrame(m_cpu, *m_interconnect, input, instructions, trace, profiler);
+        ++m_frameCount;
+    }
+
+    void Emulator::loadExecutable(const PsxExecutable& executable)
+    {
+        const std::vector<uint8_t>& text = executable.getText();
+        m_interconnect->writeRam(executable.getTextAddress(), text.data(), static_cast<uint32_t>(text.size()));
+        m_interconnect->clearRam(executable.getBssAddress(), executable.getBssSize());
+
+        m_cpu.setRegister(28, executable.getGlobalPointer()); // gp
+        m_cpu.setRegister(29, executable.getStackPointer()); // sp
+        m_cpu.setRegister(30, executable.getStackPointer()); // fp
+        m_cpu.jumpTo(executable.getEntryPoint());
+    }
+
+    void Emulator::loadExecutableAfterBoot(std::shared_ptr<const PsxExecutable> executable)
+    {
+        m_pendingExecutable = std::move(executable);
+    }
+
+    uint32_t Emulator::bootUntilShell(uint32_t instructions)
+    {
+        uint32_t count = 0;
+        for (; count < instructions; ++count)
+        {
+            if (m_cpu.getIp() == BIOS_SHELL_ENTRY_POINT)
+            {
+                loadExecutable(*m_pendingExecutable);
+                m_pendingExecutable.reset();
+                break;
+            }
+            m_cpu.runNextInstruction();
+        }
+        countMetric(Metric::Instructions, count);
+        return count;
+    }
+
+    uint32_t Emulator::getInstructionsPerFrame() const
+    {
+        return ePugStation::getInstructionsPerFrame(m_interconnect->getVideoMode());
+    }
+
+    FrameHashes Emulator::hashFrame() const
+    {
+        return ePugStation::hashFrame(*m_interconnect);
+    }
+
+    void Emulator::saveState(std::vector<uint8_t>& buffer)
+    {
+        ePugStation::saveState(m_cpu, *m_interconnect, buffer);
+    }
+
+    void Emulator::loadState(const uint8_t* data, size_t size)
+    {
+        ePugStation::loadState(m_cpu, *m_interconnect, data, size);
+    }
+}
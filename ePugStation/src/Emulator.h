@@ -0,0 +1,66 @@
+#ifndef E_PUG_STATION_EMULATOR
+#define E_PUG_STATION_EMULATOR
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "FrameHash.h"
+#include "Input.h"
+#include "Interconnect.h"
+#include "PsxExecutable.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ePugStation
+{
+    // One whole machine : CPU, RAM, DMA, interrupts and an optional GPU with its VRAM.
+    // Nothing is shared between instances but the read only BIOS image, so any number of them can
+    // run side by side, each one on a single thread at a time.
+    class Emulator
+    {
+    public:
+        Emulator() = delete;
+        // Headless without "gpu", GP0/GP1 writes are then dropped
+        explicit Emulator(std::shared_ptr<const BiosImage> bios, std::unique_ptr<GPU> gpu = nullptr);
+
+        Emulator(const Emulator&) = delete;
+        Emulator& operator=(const Emulator&) = delete;
+
+        // One frame at the length of the current video mode, ending on the VBlank interrupt
+        void runFrame(const FrameInput& input, TraceRecorder* trace = nullptr, Profiler* profiler = nullptr);
+        // Fixed length frame, for replays
+        void runFrame(const FrameInput& input, uint32_t instructions, TraceRecorder* trace = nullptr,
+                      Profiler* profiler = nullptr);
+
+        // Copies the text, clears the bss and jumps to the entry point right away. Nothing of the BIOS
+        // kernel is set up, so only for code that does not call it.
+        void loadExecutable(const PsxExecutable& executable);
+        // Boots the BIOS and loads "executable" when it jumps to the shell, with the kernel ready.
+        // Until then frames check the CPU address before every instruction and are not traced.
+        void loadExecutableAfterBoot(std::shared_ptr<const PsxExecutable> executable);
+        bool isExecutablePending() const { return m_pendingExecutable != nullptr; }
+
+        uint32_t getInstructionsPerFrame() const;
+        uint64_t getFrameCount() const { return m_frameCount; }
+        FrameHashes hashFrame() const;
+
+        void saveState(std::vector<uint8_t>& buffer);
+        void loadState(const uint8_t* data, size_t size);
+
+        CPU& getCPU() { return m_cpu; }
+        Interconnect& getInterconnect() { return *m_interconnect; }
+        const Interconnect& getInterconnect() const { return *m_interconnect; }
+
+    private:
+        // Instructions run, at most "instructions"
+        uint32_t bootUntilShell(uint32_t instructions);
+
+        std::unique_ptr<Interconnect> m_interconnect; // Before the CPU, which keeps a pointer to it
+        CPU m_cpu;
+        uint64_t m_frameCount = 0;
+        std::shared_ptr<const PsxExecutable> m_pendingExecutable;
+    };
+}
+#endif
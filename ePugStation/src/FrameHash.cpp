@@ -0,0 +1,87 @@
+#include "FrameHash.h"
+#include "Hash.h"
+#include "Interconnect.h"
+#include "SaveState.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace ePugStation
+{
+    FrameHashes hashFrame(const Interconnect& interconnect)
+    {
+        FrameHashes hashes;
+        hashes.ram = crc32c(interconnect.getRamData(), RAM_SIZE);
+        if (const GPU* gpu = interconnect.getGPU())
+        {
+            hashes.vram = crc32c(gpu->getVramData(), VRAM_SIZE_16_bit * sizeof(uint16_t));
+            hashes.display = hashVramArea(gpu->getVramData(), gpu->getDisplayArea());
+        }
+        return hashes;
+    }
+
+    uint32_t hashVramArea(const uint16_t* vram, const DisplayArea& area)
+    {
+        uint32_t crc = 0;
+        uint32_t x = area.x % VRAM_WIDTH;
+        uint32_t width = std::min(area.width, VRAM_WIDTH);
+        uint32_t firstPart = std::min(width, VRAM_WIDTH - x);
+        for (uint32_t row = 0; row < area.height; ++row)
+        {
+            const uint16_t* line = vram + ((area.y + row) % VRAM_HEIGHT) * VRAM_WIDTH;
+            crc = crc32c(line + x, firstPart * sizeof(uint16_t), crc);
+            crc = crc32c(line, (width - firstPart) * sizeof(uint16_t), crc);
+        }
+        return crc;
+    }
+
+    FrameHashLogWriter::FrameHashLogWriter(const std::string& path)
+        : m_file(path, std::ios::binary)
+    {
+        if (!m_file)
+        {
+            throw std::runtime_error("Could not create frame hash log : " + path);
+        }
+        m_file.write(reinterpret_cast<const char*>(&FRAME_HASH_LOG_MAGIC), sizeof(FRAME_HASH_LOG_MAGIC));
+        m_file.write(reinterpret_cast<const char*>(&FRAME_HASH_LOG_VERSION), sizeof(FRAME_HASH_LOG_VERSION));
+    }
+
+    void FrameHashLogWriter::append(const FrameHashes& hashes)
+    {
+        const uint32_t digests[] = { hashes.ram, hashes.vram, hashes.display };
+        m_file.write(reinterpret_cast<const char*>(digests), sizeof(digests));
+    }
+
+    std::vector<FrameHashes> readFrameHashLog(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open frame hash log : " + path);
+        }
+        std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        SaveStateReader reader(buffer.data(), buffer.size());
+        if (reader.read<uint32_t>() != FRAME_HASH_LOG_MAGIC)
+        {
+            throw std::runtime_error("Not a frame hash log : " + path);
+        }
+        uint32_t version = reader.read<uint32_t>();
+        if (version != FRAME_HASH_LOG_VERSION)
+        {
+            throw std::runtime_error("Unsupported frame hash log version : " + std::to_string(version));
+        }
+
+        std::vector<FrameHashes> frames;
+        while (!reader.isAtEnd())
+        {
+            FrameHashes hashes;
+            hashes.ram = reader.read<uint32_t>();
+            hashes.vram = reader.read<uint32_t>();
+            hashes.display = reader.read<uint32_t>();
+            frames.push_back(hashes);
+        }
+        return frames;
+    }
+}
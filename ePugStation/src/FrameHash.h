@@ -0,0 +1,48 @@
+#ifndef E_PUG_STATION_FRAME_HASH
+#define E_PUG_STATION_FRAME_HASH
+
+#include "GPU.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    class Interconnect;
+
+    // CRC32C digests of a frame, enough to compare builds without storing framebuffers
+    struct FrameHashes
+    {
+        uint32_t ram = 0;
+        uint32_t vram = 0;    // 0 without a GPU
+        uint32_t display = 0; // Displayed part of VRAM, 0 without a GPU
+
+        bool operator==(const FrameHashes& other) const { return ram == other.ram && vram == other.vram && display == other.display; }
+        bool operator!=(const FrameHashes& other) const { return !(*this == other); }
+    };
+
+    FrameHashes hashFrame(const Interconnect& interconnect);
+
+    // Row by row, wrapping around the VRAM edges like the display does
+    uint32_t hashVramArea(const uint16_t* vram, const DisplayArea& area);
+
+    // Layout : magic, version, then the 3 digests of every frame (12 bytes per frame)
+    constexpr uint32_t FRAME_HASH_LOG_MAGIC = 0x48465045; // "EPFH"
+    constexpr uint32_t FRAME_HASH_LOG_VERSION = 1;
+
+    class FrameHashLogWriter
+    {
+    public:
+        explicit FrameHashLogWriter(const std::string& path);
+
+        void append(const FrameHashes& hashes);
+
+    private:
+        std::ofstream m_file;
+    };
+
+    std::vector<FrameHashes> readFrameHashLog(const std::string& path);
+}
+#endif
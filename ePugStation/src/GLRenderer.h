@@ -0,0 +1,356 @@
+#ifndef E_PUG_STATION_GL_RENDERER
+#define E_PUG_STATION_GL_RENDERER
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "Constants.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Renderer.h"
+#include "Timeline.h"
+#include "Utils.h"
+#include "VRAM.h"
+
+#include "glad/glad.h"
+#include "SDL2/SDL.h"
+
+
+// TODO when improving...
+
+//namespace sdl2
+//{
+//    // Taken from : https://eb2.co/blog/2014/04/c--14-and-sdl2-managing-resources/
+//
+//    template<typename Creator, typename Destructor, typename... Arguments>
+//    auto make_resource(Creator c, Destructor d, Arguments&&... args)
+//    {
+//        auto r = c(std::forward<Arguments>(args)...);
+//        if (!r) { throw std::system_error(errno, std::generic_category()); }
+//        return std::unique_ptr<std::decay_t<decltype(*r)>, decltype(d)>(r, d);
+//    }
+//
+//    using window_ptr_t = std::unique_ptr<SDL_Window, decltype(&SDL_DestroyWindow)>;
+//    using renderer_ptr_t = std::unique_ptr<SDL_Renderer, decltype(&SDL_DestroyRenderer)>;
+//
+//    inline window_ptr_t makeWindow(const char* title, int x, int y, int w, int h, Uint32 flags)
+//    {
+//        return make_resource(SDL_CreateWindow, SDL_DestroyWindow, title, x, y, w, h, flags);
+//    };
+//
+//    inline renderer_ptr_t makeRenderer(SDL_Window* window, int index, Uint32 flags)
+//    {
+//        return make_resource(SDL_CreateRenderer, SDL_DestroyRenderer, window, index, flags);
+//    }
+//}
+
+namespace ePugStation
+{
+   constexpr uint32_t VERTEX_BUFFER_LENGTH = 64 * 1024;
+
+   template <typename T>
+   class Buffer
+   {
+   public:
+      Buffer();
+      ~Buffer();
+
+      void set(uint32_t index, T value);
+
+   private:
+      GLuint m_bufferObject;
+      T* m_memory;
+   };
+
+   template <typename T>
+   Buffer<T>::Buffer()
+   {
+      // Gen buffer object
+      glGenBuffers(1, &m_bufferObject);
+      // Bind it
+      glBindBuffer(GL_ARRAY_BUFFER, m_bufferObject);
+
+      GLsizeiptr elementSize = static_cast<GLsizeiptr>(sizeof(T));
+      GLsizeiptr bufferSize = elementSize * VERTEX_BUFFER_LENGTH;
+
+      // Persistent mapping
+      GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+
+      // Allocater buffer memory
+      glBufferStorage(GL_ARRAY_BUFFER, bufferSize, 0, access);
+
+      // Remap buffer
+      m_memory = (T*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, access);
+
+      // Reset array to 0
+      for (int i = 0; i < VERTEX_BUFFER_LENGTH; ++i)
+      {
+         m_memory[i] = T();
+      }
+   }
+
+   template <typename T>
+   Buffer<T>::~Buffer()
+   {
+      glBindBuffer(GL_ARRAY_BUFFER, m_bufferObject);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      glDeleteBuffers(1, &m_bufferObject);
+   }
+
+   template <typename T>
+   void Buffer<T>::set(uint32_t index, T value)
+   {
+      if (index >= VERTEX_BUFFER_LENGTH)
+      {
+         throw std::runtime_error("buffer overflow");
+      }
+
+      m_memory[index] = value;
+   }
+
+   // Needs the emulation GL context current, drawing goes to an offscreen framebuffer read back once per frame
+   class GLRenderer final : public Renderer
+   {
+   public:
+      GLRenderer()
+      {
+         glGenRenderbuffers(1, &m_colorBuffer);
+         glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+         glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, DisplayFrame::WIDTH, DisplayFrame::HEIGHT);
+         glGenFramebuffers(1, &m_framebuffer);
+         glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+         {
+            throw std::runtime_error("Offscreen framebuffer incomplete");
+         }
+         glViewport(0, 0, DisplayFrame::WIDTH, DisplayFrame::HEIGHT);
+
+         // Load shaders
+         m_vertexShader = compileShader(getFileContent(PATH_TO_VERTEX_SHADER), GL_VERTEX_SHADER);
+         m_fragmentShader = compileShader(getFileContent(PATH_TO_FRAGMENT_SHADER), GL_FRAGMENT_SHADER);
+
+         linkProgram();
+
+         glUseProgram(m_openglProgram);
+
+         // Generate vertex attribute object for vertex attributes
+         m_vao = 0;
+         glGenVertexArrays(1, &m_vao);
+         glBindVertexArray(m_vao);
+
+         // TODO: bad... until I properly understand all this
+         m_positions = new Buffer<Position>();
+         GLint index = findProgramAttribute("vertexPosition");
+         glVertexAttribIPointer(index, 2, GL_SHORT, 0, nullptr);
+         glEnableVertexAttribArray(index);
+
+         m_colors = new Buffer<CustomColor>();
+         index = findProgramAttribute("vertexColor");
+         glVertexAttribIPointer(index, 3, GL_UNSIGNED_BYTE, 0, nullptr);
+         glEnableVertexAttribArray(index);
+
+         m_texCoord = new Buffer<CustomTexCoord>();
+         index = findProgramAttribute("aTexCoord");
+         glVertexAttribIPointer(index, 2, GL_UNSIGNED_BYTE, 0, nullptr);
+         glEnableVertexAttribArray(index);
+
+         // Uniforms
+         m_uniformOffset = findProgramUniform("offset");
+         glUniform2i(m_uniformOffset, 0, 0);
+
+         m_clut4Location = findProgramUniform("clut4");
+         GLint clut4[16] = { 0 };
+         glUniform1iv(m_clut4Location, 16, clut4);
+
+         m_colorDepthLocation = findProgramUniform("colorDepth");
+         glUniform1i(m_colorDepthLocation, 16);
+
+         // 4 bit VRAM view, 4 texels per VRAM pixel
+         glGenTextures(1, &m_texture4);
+         glBindTexture(GL_TEXTURE_2D, m_texture4);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+         glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, VRAM_WIDTH_4_bit, VRAM_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+      }
+
+      ~GLRenderer() override
+      {
+         glDeleteTextures(1, &m_texture4);
+         glDeleteVertexArrays(1, &m_vao);
+         glDeleteShader(m_vertexShader);
+         glDeleteShader(m_fragmentShader);
+         glDeleteProgram(m_openglProgram);
+         glDeleteFramebuffers(1, &m_framebuffer);
+         glDeleteRenderbuffers(1, &m_colorBuffer);
+
+         delete m_positions;
+         delete m_colors;
+         delete m_texCoord;
+      }
+
+      void pushShadedPolygon(const Position* positions, const Color* colors, uint8_t numberOfVertices) override
+      {
+         pushPolygon(positions, colors, nullptr, numberOfVertices);
+      }
+
+      void pushTexturedPolygon(const Position* positions, const CustomTexCoord* texCoords, uint8_t numberOfVertices) override
+      {
+         pushPolygon(positions, nullptr, texCoords, numberOfVertices);
+      }
+
+      // Flushes the queued vertices and copies the frame out, the presentation thread shows it
+      void readFrame(DisplayFrame& frame) override
+      {
+         draw();
+         E_PUG_STATION_TIMER("Frame readback");
+         glReadPixels(0, 0, DisplayFrame::WIDTH, DisplayFrame::HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+      }
+
+      void setDrawOffset(int16_t x, int16_t y) override
+      {
+         draw();
+         glUniform2i(m_uniformOffset, static_cast<GLint>(x), static_cast<GLint>(y));
+      }
+
+      void setClut4(const int32_t clut[16]) override
+      {
+         glUniform1iv(m_clut4Location, 16, clut);
+      }
+
+      void setColorDepth(int32_t colorDepth) override
+      {  
+         glUniform1i(m_colorDepthLocation, colorDepth);
+      }
+
+      void uploadVram(const uint8_t* data4Bit) override
+      {
+         E_PUG_STATION_TIMER("VRAM upload");
+         glBindTexture(GL_TEXTURE_2D, m_texture4);
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, VRAM_WIDTH_4_bit, VRAM_HEIGHT, GL_RED, GL_UNSIGNED_BYTE, data4Bit);
+         countMetric(Metric::VramUploadBytes, VRAM_SIZE_4_bit);
+      }
+
+   private:
+      GLuint m_framebuffer;
+      GLuint m_colorBuffer;
+      GLuint m_vertexShader;
+      GLuint m_fragmentShader;
+      GLuint m_openglProgram;
+      GLuint m_vao;
+      GLuint m_uniformOffset;
+      GLint m_clut4Location;
+      GLint m_colorDepthLocation;
+      GLuint m_texture4;
+      Buffer<Position>* m_positions;
+      Buffer<CustomColor>* m_colors;
+      Buffer<CustomTexCoord>* m_texCoord;
+      uint32_t m_numberOfVertices = 0;
+
+      // Untextured without "texCoords", uncolored without "colors"
+      void pushPolygon(const Position* positions, const Color* colors, const CustomTexCoord* texCoords, uint8_t numberOfVertices)
+      {
+         uint8_t totalNumberOfVertices = (numberOfVertices == 3) ? 3 : 6;
+         if ((m_numberOfVertices + totalNumberOfVertices) > VERTEX_BUFFER_LENGTH)
+         {
+            E_PUG_STATION_LOG(Debug, Renderer, "Vertex attribute buffers full, forcing draw");
+            draw();
+         }
+         countMetric(Metric::Vertices, totalNumberOfVertices);
+
+         // Quads as 0 1 2 then 1 2 3
+         static constexpr uint8_t QUAD_ORDER[6] = { 0, 1, 2, 1, 2, 3 };
+         for (uint8_t i = 0; i < totalNumberOfVertices; ++i)
+         {
+            uint8_t vertex = QUAD_ORDER[i];
+            m_positions->set(m_numberOfVertices, positions[vertex]);
+            m_colors->set(m_numberOfVertices, colors ? CustomColor(colors[vertex]) : CustomColor());
+            m_texCoord->set(m_numberOfVertices, texCoords ? texCoords[vertex] : CustomTexCoord(69, 69));
+            ++m_numberOfVertices;
+         }
+      }
+
+      GLuint compileShader(const std::string& content, GLenum shaderType)
+      {
+         GLuint shader = glCreateShader(shaderType);
+
+         const GLchar* source = (const GLchar*)content.c_str();
+         glShaderSource(shader, 1, &source, nullptr);
+         glCompileShader(shader);
+
+         // Error checking
+         GLint status = GL_FALSE;
+         glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+         if (status != GL_TRUE)
+         {
+            throw std::runtime_error("Shader compilation failed");
+         }
+         return shader;
+      }
+
+      void linkProgram()
+      {
+         m_openglProgram = glCreateProgram();
+
+         glAttachShader(m_openglProgram, m_vertexShader);
+         glAttachShader(m_openglProgram, m_fragmentShader);
+
+         glLinkProgram(m_openglProgram);
+
+         // Error checking
+         GLint status = GL_FALSE;
+         glGetProgramiv(m_openglProgram, GL_LINK_STATUS, &status);
+         if (status != GL_TRUE)
+         {
+            throw std::runtime_error("OpenGL program linking failed");
+         }
+      }
+
+      GLuint findProgramUniform(const std::string& attribute)
+      {
+         const GLchar* source = (const GLchar*)attribute.c_str();
+         GLint index = glGetUniformLocation(m_openglProgram, source);
+
+         if (index < 0)
+         {
+            throw std::runtime_error("Uniform attribute not found in program");
+         }
+         return index;
+      }
+
+      GLuint findProgramAttribute(const std::string& attribute)
+      {
+         const GLchar* source = (const GLchar*)attribute.c_str();
+         GLint index = glGetAttribLocation(m_openglProgram, source);
+
+         if (index < 0)
+         {
+            throw std::runtime_error("Attribute not found in program");
+         }
+         return index;
+      }
+
+      // TODO: Inefficient, CPU is stalling... Could use double or triple buffering (for later)
+      void draw()
+      {
+         E_PUG_STATION_TIMER("Draw");
+         // Make sure persistent mapping data is flushed to the buffer
+         glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+         glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_numberOfVertices));
+         countMetric(Metric::DrawCalls);
+
+         // Wait for GPU to complete
+         auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+         bool complete = false;
+         while (!complete)
+         {
+            auto result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
+            complete = (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED);
+         }
+         m_numberOfVertices = 0;
+      }
+   };
+}
+#endif
\ No newline at end of file
@@ -2,7 +2,11 @@
 #define E_PUG_STATION_GPU
 
 #include "Constants.h"
-#include "SDLContext.h"
+#include "DMAPort.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Timeline.h"
+#include "SaveState.h"
 #include "Renderer.h"
 #include "VRAM.h"
 #include "Types.h"
@@ -10,9 +14,10 @@
 #include <cstdint>
 #include <vector>
 #include <functional>
-#include <iostream>
 #include <stdexcept>
 #include <array>
+#include <algorithm>
+#include <memory>
 
 namespace ePugStation
 {
@@ -51,6 +56,20 @@ namespace ePugStation
       PAL = 1   // 576i50Hz
    };
 
+   constexpr uint32_t CPU_CLOCK_RATE = 33868800; // Hz
+
+   // The emulated VBlank follows the refresh rate of the video mode
+   constexpr double getRefreshRate(VideoMode videoMode)
+   {
+      return videoMode == VideoMode::PAL ? 50.0 : 59.94;
+   }
+
+   // CPU cycles between two VBlanks, counting one instruction per cycle
+   constexpr uint32_t getInstructionsPerFrame(VideoMode videoMode)
+   {
+      return static_cast<uint32_t>(CPU_CLOCK_RATE / getRefreshRate(videoMode));
+   }
+
    enum class Field : unsigned
    {
       Bottom = 0,
@@ -87,6 +106,15 @@ namespace ePugStation
       };
    };
 
+   // Part of VRAM sent to the TV, in 16 bit VRAM pixels
+   struct DisplayArea
+   {
+      uint32_t x;
+      uint32_t y;
+      uint32_t width;
+      uint32_t height;
+   };
+
    struct HSyncDisplay
    {
       HSyncDisplay() : value(0) {}
@@ -315,11 +343,12 @@ namespace ePugStation
       };
    };
 
-   class GPU
+   class GPU : public DMAPort
    {
    public:
-      GPU(SDLContext* sdlContext)
-         : m_renderer(sdlContext)
+      // Headless without "renderer", commands still update the software VRAM
+      explicit GPU(std::unique_ptr<Renderer> renderer = nullptr)
+         : m_renderer(std::move(renderer))
       {
          m_stat.bit.isDisplayDisabled = true;
          m_stat.bit.readyToReceiveCmd = 1;
@@ -340,6 +369,13 @@ namespace ePugStation
 
       void setGP0Command(uint32_t value)
       {
+         // Words of the command in flight, replayed on state load to rebuild m_cmdFx
+         if (m_requestsMissing == 0)
+         {
+            m_commandWords.clear();
+         }
+         m_commandWords.push_back(value);
+
          m_gp0 = GP0(value);
          decodeAndExecuteGP0();
       }
@@ -350,8 +386,150 @@ namespace ePugStation
          decodeAndExecuteGP1();
       }
 
+      // DMA channel 2 : GPUREAD
+      void readWords(uint32_t* words, size_t count) override
+      {
+         E_PUG_STATION_LOG(Warning, GPU, "GPUREAD DMA not implemented, ignoring...");
+         std::fill(words, words + count, 0);
+      }
+
+      // DMA channel 2 : GP0
+      void writeWords(const uint32_t* words, size_t count) override
+      {
+         for (size_t i = 0; i < count; ++i)
+         {
+            setGP0Command(words[i]);
+         }
+      }
+
+      // Registers and the command in flight, VRAM content is accessed by tiles
+      void saveState(SaveStateWriter& writer) const
+      {
+         saveRegisters(writer);
+         savePendingCommand(writer);
+      }
+
+      void loadState(SaveStateReader& reader)
+      {
+         loadRegisters(reader);
+         loadPendingCommand(reader);
+      }
+
+      // Moves past a state written by saveState without applying it
+      void skipState(SaveStateReader& reader) const
+      {
+         reader.view(savedSize([this](SaveStateWriter& writer) { saveRegisters(writer); }));
+         uint32_t pendingWords = reader.read<uint32_t>();
+         reader.view(static_cast<size_t>(pendingWords) * sizeof(uint32_t));
+      }
+
+      VideoMode getVideoMode() const { return m_stat.bit.videoMode; }
+
+      // Draws what is queued and copies the frame out, once per emulated VBlank
+      void captureFrame(DisplayFrame& frame)
+      {
+         if (m_renderer)
+         {
+            m_renderer->readFrame(frame);
+         }
+      }
+
+      DisplayArea getDisplayArea() const
+      {
+         uint32_t width = 256;
+         switch (m_stat.bit.hRes)
+         {
+         case HorizontalResolution::H256: width = 256; break;
+         case HorizontalResolution::H368: width = 368; break;
+         case HorizontalResolution::H320: width = 320; break;
+         case HorizontalResolution::H512: width = 512; break;
+         case HorizontalResolution::H640: width = 640; break;
+         }
+         // 24 bit pixels span one and a half VRAM pixels
+         if (m_stat.bit.displayDepth == DisplayDepth::D24bit)
+         {
+            width = width * 3 / 2;
+         }
+         uint32_t height = (m_stat.bit.vRes == VerticalResolution::V480 && m_stat.bit.isInterlaced) ? 480 : 240;
+         return { m_vramDisplay.bit.xStart, m_vramDisplay.bit.yStart, width, height };
+      }
+
+      const uint16_t* getVramData() const { return m_vram.data(); }
+      void restoreVram(const void* data)
+      {
+         m_vram.restore(data);
+         uploadVram();
+      }
+
+      const DirtyPages<VRAM_TILE_COUNT>& getDirtyVramTiles() const { return m_vram.getDirtyTiles(); }
+      void readVramTile(uint32_t tile, uint8_t* data) const { m_vram.readTile(tile, data); }
+      void writeVramTile(uint32_t tile, const uint8_t* data) { m_vram.writeTile(tile, data); }
+      void uploadVram()
+      {
+         if (m_renderer)
+         {
+            m_renderer->uploadVram(m_vram.data4Bit());
+         }
+      }
+      void clearDirtyState(DirtyTracker tracker) { m_vram.clearDirtyTiles(tracker); }
+
    private:
-      Renderer m_renderer;
+      void saveRegisters(SaveStateWriter& writer) const
+      {
+         writer.write(m_stat.value);
+         writer.write(m_gp0.value);
+         writer.write(m_gp1.value);
+         writer.write(m_vramDisplay.value);
+         writer.write(m_vSyncDisplay.value);
+         writer.write(m_hSyncDisplay.value);
+         writer.write(m_textureWindowSettings.value);
+         writer.write(m_drawingAreaTopLeft.value);
+         writer.write(m_drawingAreaBottomRight.value);
+         writer.write(m_drawingOffset.value);
+      }
+
+      void loadRegisters(SaveStateReader& reader)
+      {
+         m_stat.value = reader.read<uint32_t>();
+         m_gp0 = GP0(reader.read<uint32_t>());
+         m_gp1 = GP1(reader.read<uint32_t>());
+         m_vramDisplay = VRAMDisplay(reader.read<uint32_t>());
+         m_vSyncDisplay = VSyncDisplay(reader.read<uint32_t>());
+         m_hSyncDisplay = HSyncDisplay(reader.read<uint32_t>());
+         m_textureWindowSettings = TextureWindowSettings(reader.read<uint32_t>());
+         m_drawingAreaTopLeft = DrawingCoordinate(reader.read<uint32_t>());
+         m_drawingAreaBottomRight = DrawingCoordinate(reader.read<uint32_t>());
+         m_drawingOffset = DrawingOffset(reader.read<uint32_t>());
+         if (m_renderer)
+         {
+            m_renderer->setDrawOffset(m_drawingOffset.bit.xOffset, m_drawingOffset.bit.yOffset);
+         }
+      }
+
+      void savePendingCommand(SaveStateWriter& writer) const
+      {
+         uint32_t pendingWords = m_requestsMissing > 0 ? static_cast<uint32_t>(m_commandWords.size()) : 0;
+         writer.write(pendingWords);
+         writer.writeBlock(m_commandWords.data(), pendingWords * sizeof(uint32_t));
+      }
+
+      void loadPendingCommand(SaveStateReader& reader)
+      {
+         uint32_t pendingWords = reader.read<uint32_t>();
+         std::vector<uint32_t> words(pendingWords);
+         reader.readBlock(words.data(), pendingWords * sizeof(uint32_t));
+
+         // Replaying the header words only queues the command, it executes on its last word
+         resetCommandBuffer();
+         GP0 gp0 = m_gp0;
+         for (uint32_t word : words)
+         {
+            setGP0Command(word);
+         }
+         m_gp0 = gp0;
+      }
+
+      std::unique_ptr<Renderer> m_renderer;
       // Probably better to couple these once I understand their use (Display rectangle ?)
       GPUStat m_stat;
       GP0 m_gp0;
@@ -371,6 +549,7 @@ namespace ePugStation
 
       // vector of GP0 values
       std::vector<GP0> m_renderValues;
+      std::vector<uint32_t> m_commandWords;
 
       void decodeAndExecuteGP1()
       {
@@ -483,11 +662,13 @@ namespace ePugStation
          {
             m_renderValues.push_back(m_gp0);
             m_requestsMissing = 0;
+            E_PUG_STATION_TIMER("GP0 command");
             m_cmdFx();
             m_renderValues.clear();
          }
          else // Behave normally, since no multi operation was queued...
          {
+            countGp0Command(static_cast<uint8_t>(m_gp0.CMD_OP.value));
             switch (m_gp0.CMD_OP.value)
             {
             case 0x00: break; // NOOP
@@ -535,7 +716,7 @@ namespace ePugStation
       void clearCache()
       {
          // TODO: Implement me. This function will clear texture cache, once implemented.
-         std::cout << "Unhandled clearCache" << std::endl;
+         E_PUG_STATION_LOG(Warning, GPU, "Unhandled clearCache");
       }
 
       // TODO: Change the template params for enums ? Opaque or Semi-Transparent, TextureBlending or RawTexture
@@ -550,7 +731,11 @@ namespace ePugStation
             positions[i] = m_renderValues[1 + i].position;
             colors[i] = m_renderValues[0].color;
          }
-         m_renderer.pushMonochromePolygon<numberOfVertex>(positions, colors);
+         if (m_renderer)
+         {
+            // Flat colors as shaded ones for now
+            m_renderer->pushShadedPolygon(positions, colors, numberOfVertex);
+         }
       }
 
       // gp0 : 0x30, 0x32, 0x38, 0x3A
@@ -564,7 +749,10 @@ namespace ePugStation
             positions[i] = m_renderValues[1 + (i * 2)].position;
             colors[i] = m_renderValues[i * 2].color;
          }
-         m_renderer.pushShadedPolygon<numberOfVertex>(positions, colors);
+         if (m_renderer)
+         {
+            m_renderer->pushShadedPolygon(positions, colors, numberOfVertex);
+         }
       }
 
       // gp0 : 0x24, 0x25, 0x26, 0x27, 0x2C, 0x2D, 0x2E, 0x2F
@@ -575,17 +763,20 @@ namespace ePugStation
          auto texPage = m_renderValues[4].texCoord.texPage;
          if (texPage.texPageColors == 0) // 4 bit
          {
-            GLint clutData[16];
+            int32_t clutData[16];
             int xPos = clut.x * 16;
             for (int i = 0; i < 16; ++i)
             {
                clutData[i] = m_vram.read(xPos + i, clut.y);
             }
-            m_renderer.setClut4(clutData);
+            if (m_renderer)
+            {
+               m_renderer->setClut4(clutData);
+            }
          }
          else
          {
-            std::cout << "Not supporting other modes than 4 bit atm!\n";
+            E_PUG_STATION_LOG(Warning, GPU, "Not supporting other modes than 4 bit atm!");
          }
 
          int pageXPos = texPage.xBase * 64;
@@ -602,8 +793,11 @@ namespace ePugStation
             textures[i] = CustomTexCoord(xCoord, yCoord);
          }
 
-         m_renderer.setColorDepth(4);
-         m_renderer.pushTexturedPolygon<numberOfVertex>(positions, textures);
+         if (m_renderer)
+         {
+            m_renderer->setColorDepth(4);
+            m_renderer->pushTexturedPolygon(positions, textures, numberOfVertex);
+         }
       }
 
       //  gp0 : 0xA0
@@ -622,24 +816,19 @@ namespace ePugStation
             int startY = recCoord.bit.yValue;
             int endY = startY + rect.bit.height;
 
-            // TODO: for debugging purposes, remove me
-            static int counter = 0;
-            ++counter;
-            if (counter < 13)
+            int dataIndex = 0;
+            E_PUG_STATION_LOG(Debug, GPU, "y : %d-%d x: %d-%d", startY, endY, startX, endX);
+            // Rectangles crossing an edge wrap around VRAM
+            for (int y = startY; y < endY; ++y)
             {
-               int dataIndex = 0;
-               std::cout << "y : " << startY << "-" << endY << " x: " << startX << "-" << endX << '\n';
-               for (int y = startY; y < endY; ++y)
+               for (int x = startX; x < endX; x += 2)
                {
-                  for (int x = startX; x < endX; x += 2)
-                  {
-                     m_vram.write(x, y, m_renderValues[dataIndex].value & 0xffff);
-                     m_vram.write(x + 1, y, m_renderValues[dataIndex].value >> 16);
-                     ++dataIndex;
-                  }
+                  m_vram.write(x & (VRAM_WIDTH - 1), y & (VRAM_HEIGHT - 1), m_renderValues[dataIndex].value & 0xffff);
+                  m_vram.write((x + 1) & (VRAM_WIDTH - 1), y & (VRAM_HEIGHT - 1), m_renderValues[dataIndex].value >> 16);
+                  ++dataIndex;
                }
-               m_vram.uploadToGPU();
             }
+            uploadVram();
          };
       }
 
@@ -647,7 +836,7 @@ namespace ePugStation
       void imageStore()
       {
          // TODO Implement me...
-         std::cout << "Unhandled image store" << std::endl;
+         E_PUG_STATION_LOG(Warning, GPU, "Unhandled image store");
       }
 
       // gp0 : 0xE1
@@ -684,10 +873,11 @@ namespace ePugStation
       // gp0 : 0xE5 --> Not stored in FIFO ? ** Probably executed immediately ** 
       void setDrawingOffset(DrawingOffset offset)
       {
-         m_renderer.setDrawOffset(offset.bit.xOffset, offset.bit.yOffset);
-
-         // Hack for now
-         m_renderer.display();
+         m_drawingOffset = offset;
+         if (m_renderer)
+         {
+            m_renderer->setDrawOffset(offset.bit.xOffset, offset.bit.yOffset);
+         }
       }
 
       // gp0 : 0xE6
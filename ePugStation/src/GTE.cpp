@@ -0,0 +1,843 @@
+#include "GTE.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using namespace ePugStation;
+
+    // FLAG register bits (cop2r63)
+    constexpr uint32_t FLAG_MAC_POSITIVE_OVERFLOW[4] = { 1u << 16, 1u << 30, 1u << 29, 1u << 28 };
+    constexpr uint32_t FLAG_MAC_NEGATIVE_OVERFLOW[4] = { 1u << 15, 1u << 27, 1u << 26, 1u << 25 };
+    constexpr uint32_t FLAG_IR_SATURATED[4] = { 1u << 12, 1u << 24, 1u << 23, 1u << 22 };
+    constexpr uint32_t FLAG_COLOR_SATURATED[3] = { 1u << 21, 1u << 20, 1u << 19 };
+    constexpr uint32_t FLAG_SZ3_OTZ_SATURATED = 1u << 18;
+    constexpr uint32_t FLAG_DIVIDE_OVERFLOW = 1u << 17;
+    constexpr uint32_t FLAG_SX2_SATURATED = 1u << 14;
+    constexpr uint32_t FLAG_SY2_SATURATED = 1u << 13;
+    constexpr uint32_t FLAG_ERROR = 1u << 31;
+    constexpr uint32_t FLAG_ERROR_BITS = 0x7f87e000; // Bits 30-23 and 18-13
+    constexpr uint32_t FLAG_WRITE_MASK = 0x7ffff000;
+
+    constexpr int64_t MAC_MAX = 0x7ffffffffff;  // 44 bits
+    constexpr int64_t MAC_MIN = -0x80000000000;
+
+    uint32_t signExtend16(uint32_t value)
+    {
+        return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(value)));
+    }
+
+    uint32_t pack16(int16_t low, int16_t high)
+    {
+        return static_cast<uint16_t>(low) | (static_cast<uint32_t>(static_cast<uint16_t>(high)) << 16);
+    }
+
+    uint32_t packColor(const GTEColor& color)
+    {
+        return color[0] | (color[1] << 8) | (color[2] << 16) | (static_cast<uint32_t>(color[3]) << 24);
+    }
+
+    GTEColor unpackColor(uint32_t value)
+    {
+        return { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+    }
+
+    // Matrix registers are packed two elements per register, the fifth register only holds the last one
+    uint32_t getMatrixReg(const GTEMatrix& matrix, uint32_t index)
+    {
+        if (index == 4)
+        {
+            return signExtend16(static_cast<uint16_t>(matrix[8]));
+        }
+        return pack16(matrix[index * 2], matrix[index * 2 + 1]);
+    }
+
+    void setMatrixReg(GTEMatrix& matrix, uint32_t index, uint32_t value)
+    {
+        matrix[index * 2] = static_cast<int16_t>(value);
+        if (index != 4)
+        {
+            matrix[index * 2 + 1] = static_cast<int16_t>(value >> 16);
+        }
+    }
+
+    // products[row * 3 + col] = matrix[row][col] * vector[col]
+    // 16x16 bit products always fit in 32 bits, so lanes never overflow and
+    // accumulation (with the 44 bit overflow checks) stays in scalar code.
+    void multiplyElements(const GTEMatrix& matrix, const GTEVector& vector, std::array<int32_t, 9>& products)
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix.data()));
+        const __m128i v = _mm_setr_epi16(vector[0], vector[1], vector[2], vector[0], vector[1], vector[2], vector[0], vector[1]);
+        const __m128i low = _mm_mullo_epi16(m, v);
+        const __m128i high = _mm_mulhi_epi16(m, v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&products[0]), _mm_unpacklo_epi16(low, high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&products[4]), _mm_unpackhi_epi16(low, high));
+        products[8] = matrix[8] * vector[2];
+#else
+        for (uint32_t i = 0; i < 9; ++i)
+        {
+            products[i] = matrix[i] * vector[i % 3];
+        }
+#endif
+    }
+
+    // RTPT : products of the rotation matrix with V0, V1 and V2 in a single pass.
+    // "batch" holds the matrix replicated three times (27 lanes used out of 32),
+    // products[vertex * 9 + row * 3 + col] = rotation[row][col] * V(vertex)[col]
+    void multiplyElementsBatch(const GTEBatchMatrix& batch, const std::array<GTEVector, 3>& v, std::array<int32_t, 32>& products)
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i vectors[4] = {
+            _mm_setr_epi16(v[0][0], v[0][1], v[0][2], v[0][0], v[0][1], v[0][2], v[0][0], v[0][1]),
+            _mm_setr_epi16(v[0][2], v[1][0], v[1][1], v[1][2], v[1][0], v[1][1], v[1][2], v[1][0]),
+            _mm_setr_epi16(v[1][1], v[1][2], v[2][0], v[2][1], v[2][2], v[2][0], v[2][1], v[2][2]),
+            _mm_setr_epi16(v[2][0], v[2][1], v[2][2], 0, 0, 0, 0, 0)
+        };
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.data() + i * 8));
+            const __m128i low = _mm_mullo_epi16(m, vectors[i]);
+            const __m128i high = _mm_mulhi_epi16(m, vectors[i]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&products[i * 8]), _mm_unpacklo_epi16(low, high));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&products[i * 8 + 4]), _mm_unpackhi_epi16(low, high));
+        }
+#else
+        for (uint32_t i = 0; i < 27; ++i)
+        {
+            products[i] = batch[i] * v[i / 9][i % 3];
+        }
+#endif
+    }
+
+    uint32_t countLeadingZeros16(uint16_t value)
+    {
+        uint32_t count = 0;
+        for (uint16_t bit = 0x8000; bit != 0 && (value & bit) == 0; bit >>= 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    // Count of leading bits equal to the sign bit (1..32)
+    uint32_t countLeadingSignBits(uint32_t value)
+    {
+        if (value & 0x80000000)
+        {
+            value = ~value;
+        }
+        uint32_t count = 0;
+        for (uint32_t bit = 0x80000000; bit != 0 && (value & bit) == 0; bit >>= 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    // Unsigned Newton-Raphson reciprocal seed table used by the hardware divider
+    constexpr std::array<uint8_t, 257> generateUNRTable()
+    {
+        std::array<uint8_t, 257> table{};
+        for (int i = 0; i < 257; ++i)
+        {
+            table[i] = static_cast<uint8_t>(std::max(0, ((0x40000 / (i + 0x100)) + 1) / 2 - 0x101));
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 257> UNR_TABLE = generateUNRTable();
+    static_assert(UNR_TABLE[0] == 0xff && UNR_TABLE[0x80] == 0x54 && UNR_TABLE[0x100] == 0x00, "UNR table mismatch with hardware");
+}
+
+namespace ePugStation
+{
+    GTE::GTE() :
+        m_v(),
+        m_rgbc(),
+        m_otz(0),
+        m_ir(),
+        m_sx(),
+        m_sy(),
+        m_sz(),
+        m_rgb(),
+        m_res1(0),
+        m_mac(),
+        m_lzcs(0),
+        m_lzcr(32),
+        m_rotation(),
+        m_rotationBatch(),
+        m_translation(),
+        m_lightSource(),
+        m_backgroundColor(),
+        m_lightColor(),
+        m_farColor(),
+        m_ofx(0),
+        m_ofy(0),
+        m_h(0),
+        m_dqa(0),
+        m_dqb(0),
+        m_zsf3(0),
+        m_zsf4(0),
+        m_flag(0)
+    {
+    }
+
+    uint32_t GTE::getData(uint32_t index) const
+    {
+        switch (index)
+        {
+        case 0: case 2: case 4: return pack16(m_v[index / 2][0], m_v[index / 2][1]);
+        case 1: case 3: case 5: return signExtend16(static_cast<uint16_t>(m_v[index / 2][2]));
+        case 6: return packColor(m_rgbc);
+        case 7: return m_otz;
+        case 8: case 9: case 10: case 11: return signExtend16(static_cast<uint16_t>(m_ir[index - 8]));
+        case 12: case 13: case 14: return pack16(m_sx[index - 12], m_sy[index - 12]);
+        case 15: return pack16(m_sx[2], m_sy[2]);
+        case 16: case 17: case 18: case 19: return m_sz[index - 16];
+        case 20: case 21: case 22: return packColor(m_rgb[index - 20]);
+        case 23: return m_res1;
+        case 24: case 25: case 26: case 27: return static_cast<uint32_t>(m_mac[index - 24]);
+        case 28:
+        case 29:
+        {
+            // ORGB : IR1-3 saturated to 5 bits
+            auto toColor = [](int16_t ir) { return static_cast<uint32_t>(std::clamp(ir / 0x80, 0, 0x1f)); };
+            return toColor(m_ir[1]) | (toColor(m_ir[2]) << 5) | (toColor(m_ir[3]) << 10);
+        }
+        case 30: return m_lzcs;
+        case 31: return m_lzcr;
+        default:
+            throw std::runtime_error("Invalid GTE data register : " + std::to_string(index));
+        }
+    }
+
+    void GTE::setData(uint32_t index, uint32_t value)
+    {
+        switch (index)
+        {
+        case 0: case 2: case 4:
+            m_v[index / 2][0] = static_cast<int16_t>(value);
+            m_v[index / 2][1] = static_cast<int16_t>(value >> 16);
+            break;
+        case 1: case 3: case 5: m_v[index / 2][2] = static_cast<int16_t>(value); break;
+        case 6: m_rgbc = unpackColor(value); break;
+        case 7: m_otz = static_cast<uint16_t>(value); break;
+        case 8: case 9: case 10: case 11: m_ir[index - 8] = static_cast<int16_t>(value); break;
+        case 12: case 13: case 14:
+            m_sx[index - 12] = static_cast<int16_t>(value);
+            m_sy[index - 12] = static_cast<int16_t>(value >> 16);
+            break;
+        case 15:
+            // SXYP : pushes on the FIFO
+            m_sx[0] = m_sx[1]; m_sx[1] = m_sx[2]; m_sx[2] = static_cast<int16_t>(value);
+            m_sy[0] = m_sy[1]; m_sy[1] = m_sy[2]; m_sy[2] = static_cast<int16_t>(value >> 16);
+            break;
+        case 16: case 17: case 18: case 19: m_sz[index - 16] = static_cast<uint16_t>(value); break;
+        case 20: case 21: case 22: m_rgb[index - 20] = unpackColor(value); break;
+        case 23: m_res1 = value; break;
+        case 24: case 25: case 26: case 27: m_mac[index - 24] = static_cast<int32_t>(value); break;
+        case 28:
+            // IRGB : expands 5 bit colors to IR1-3
+            m_ir[1] = static_cast<int16_t>((value & 0x1f) * 0x80);
+            m_ir[2] = static_cast<int16_t>(((value >> 5) & 0x1f) * 0x80);
+            m_ir[3] = static_cast<int16_t>(((value >> 10) & 0x1f) * 0x80);
+            break;
+        case 29: break; // ORGB is read only
+        case 30:
+            m_lzcs = value;
+            m_lzcr = countLeadingSignBits(value);
+            break;
+        case 31: break; // LZCR is read only
+        default:
+            throw std::runtime_error("Invalid GTE data register : " + std::to_string(index));
+        }
+    }
+
+    uint32_t GTE::getControl(uint32_t index) const
+    {
+        switch (index)
+        {
+        case 0: case 1: case 2: case 3: case 4: return getMatrixReg(m_rotation, index);
+        case 5: case 6: case 7: return static_cast<uint32_t>(m_translation[index - 5]);
+        case 8: case 9: case 10: case 11: case 12: return getMatrixReg(m_lightSource, index - 8);
+        case 13: case 14: case 15: return static_cast<uint32_t>(m_backgroundColor[index - 13]);
+        case 16: case 17: case 18: case 19: case 20: return getMatrixReg(m_lightColor, index - 16);
+        case 21: case 22: case 23: return static_cast<uint32_t>(m_farColor[index - 21]);
+        case 24: return static_cast<uint32_t>(m_ofx);
+        case 25: return static_cast<uint32_t>(m_ofy);
+        case 26: return signExtend16(m_h); // Unsigned, but read back sign extended (hardware bug)
+        case 27: return signExtend16(static_cast<uint16_t>(m_dqa));
+        case 28: return static_cast<uint32_t>(m_dqb);
+        case 29: return signExtend16(static_cast<uint16_t>(m_zsf3));
+        case 30: return signExtend16(static_cast<uint16_t>(m_zsf4));
+        case 31: return m_flag;
+        default:
+            throw std::runtime_error("Invalid GTE control register : " + std::to_string(index));
+        }
+    }
+
+    void GTE::setControl(uint32_t index, uint32_t value)
+    {
+        switch (index)
+        {
+        case 0: case 1: case 2: case 3: case 4:
+            setMatrixReg(m_rotation, index, value);
+            for (uint32_t i = 0; i < 27; ++i)
+            {
+                m_rotationBatch[i] = m_rotation[i % 9];
+            }
+            break;
+        case 5: case 6: case 7: m_translation[index - 5] = static_cast<int32_t>(value); break;
+        case 8: case 9: case 10: case 11: case 12: setMatrixReg(m_lightSource, index - 8, value); break;
+        case 13: case 14: case 15: m_backgroundColor[index - 13] = static_cast<int32_t>(value); break;
+        case 16: case 17: case 18: case 19: case 20: setMatrixReg(m_lightColor, index - 16, value); break;
+        case 21: case 22: case 23: m_farColor[index - 21] = static_cast<int32_t>(value); break;
+        case 24: m_ofx = static_cast<int32_t>(value); break;
+        case 25: m_ofy = static_cast<int32_t>(value); break;
+        case 26: m_h = static_cast<uint16_t>(value); break;
+        case 27: m_dqa = static_cast<int16_t>(value); break;
+        case 28: m_dqb = static_cast<int32_t>(value); break;
+        case 29: m_zsf3 = static_cast<int16_t>(value); break;
+        case 30: m_zsf4 = static_cast<int16_t>(value); break;
+        case 31:
+            m_flag = value & FLAG_WRITE_MASK;
+            if (m_flag & FLAG_ERROR_BITS)
+            {
+                m_flag |= FLAG_ERROR;
+            }
+            break;
+        default:
+            throw std::runtime_error("Invalid GTE control register : " + std::to_string(index));
+        }
+    }
+
+    void GTE::saveState(SaveStateWriter& writer) const
+    {
+        writer.write(m_v);
+        writer.write(m_rgbc);
+        writer.write(m_otz);
+        writer.write(m_ir);
+        writer.write(m_sx);
+        writer.write(m_sy);
+        writer.write(m_sz);
+        writer.write(m_rgb);
+        writer.write(m_res1);
+        writer.write(m_mac);
+        writer.write(m_lzcs);
+        writer.write(m_lzcr);
+
+        // Control registers have no write side effects, round trip them through CTC2
+        for (uint32_t i = 0; i < 32; ++i)
+        {
+            writer.write(getControl(i));
+        }
+    }
+
+    void GTE::loadState(SaveStateReader& reader)
+    {
+        m_v = reader.read<decltype(m_v)>();
+        m_rgbc = reader.read<GTEColor>();
+        m_otz = reader.read<uint16_t>();
+        m_ir = reader.read<decltype(m_ir)>();
+        m_sx = reader.read<decltype(m_sx)>();
+        m_sy = reader.read<decltype(m_sy)>();
+        m_sz = reader.read<decltype(m_sz)>();
+        m_rgb = reader.read<decltype(m_rgb)>();
+        m_res1 = reader.read<uint32_t>();
+        m_mac = reader.read<decltype(m_mac)>();
+        m_lzcs = reader.read<uint32_t>();
+        m_lzcr = reader.read<uint32_t>();
+
+        for (uint32_t i = 0; i < 32; ++i)
+        {
+            setControl(i, reader.read<uint32_t>());
+        }
+    }
+
+    void GTE::execute(uint32_t value)
+    {
+        GTECommand command(value);
+        const uint8_t shift = command.bit.sf ? 12 : 0;
+        const bool lm = command.bit.lm;
+
+        m_flag = 0;
+
+        switch (command.bit.opcode)
+        {
+        case GTEOp::RTPS: opRTPS(0, shift, lm, true); break;
+        case GTEOp::NCLIP: opNCLIP(); break;
+        case GTEOp::OP: opOP(shift, lm); break;
+        case GTEOp::DPCS: opDPCS(m_rgbc, shift, lm); break;
+        case GTEOp::INTPL: opINTPL(shift, lm); break;
+        case GTEOp::MVMVA: opMVMVA(command); break;
+        case GTEOp::NCDS: opNCDS(0, shift, lm); break;
+        case GTEOp::CDP: opCDP(shift, lm); break;
+        case GTEOp::NCDT: opNCDS(0, shift, lm); opNCDS(1, shift, lm); opNCDS(2, shift, lm); break;
+        case GTEOp::NCCS: opNCCS(0, shift, lm); break;
+        case GTEOp::CC: opCC(shift, lm); break;
+        case GTEOp::NCS: opNCS(0, shift, lm); break;
+        case GTEOp::NCT: opNCS(0, shift, lm); opNCS(1, shift, lm); opNCS(2, shift, lm); break;
+        case GTEOp::SQR: opSQR(shift, lm); break;
+        case GTEOp::DCPL: opDCPL(shift, lm); break;
+        case GTEOp::DPCT:
+            // Always uses the bottom of the FIFO, which moves after each push
+            opDPCS(m_rgb[0], shift, lm);
+            opDPCS(m_rgb[0], shift, lm);
+            opDPCS(m_rgb[0], shift, lm);
+            break;
+        case GTEOp::AVSZ3: opAVSZ3(); break;
+        case GTEOp::AVSZ4: opAVSZ4(); break;
+        case GTEOp::RTPT: opRTPT(shift, lm); break;
+        case GTEOp::GPF: opGPF(shift, lm); break;
+        case GTEOp::GPL: opGPL(shift, lm); break;
+        case GTEOp::NCCT: opNCCS(0, shift, lm); opNCCS(1, shift, lm); opNCCS(2, shift, lm); break;
+        default:
+            throw std::runtime_error("Unhandled GTE command : " + std::to_string(value & 0x3f));
+        }
+
+        if (m_flag & FLAG_ERROR_BITS)
+        {
+            m_flag |= FLAG_ERROR;
+        }
+    }
+
+    // RTPS : perspective transformation
+    void GTE::opRTPS(uint32_t vectorIndex, uint8_t shift, bool lm, bool last)
+    {
+        std::array<int32_t, 9> products;
+        multiplyElements(m_rotation, m_v[vectorIndex], products);
+        projectVertex(products.data(), shift, lm, last);
+    }
+
+    // RTPT : perspective transformation of V0, V1 and V2, products of the three vertices are computed together
+    void GTE::opRTPT(uint8_t shift, bool lm)
+    {
+        std::array<int32_t, 32> products;
+        multiplyElementsBatch(m_rotationBatch, m_v, products);
+        projectVertex(&products[0], shift, lm, false);
+        projectVertex(&products[9], shift, lm, false);
+        projectVertex(&products[18], shift, lm, true);
+    }
+
+    void GTE::projectVertex(const int32_t* products, uint8_t shift, bool lm, bool last)
+    {
+        std::array<int64_t, 3> sums;
+        for (uint32_t row = 0; row < 3; ++row)
+        {
+            int64_t sum = checkMac(row + 1, (static_cast<int64_t>(m_translation[row]) << 12) + products[row * 3]);
+            sum = checkMac(row + 1, sum + products[row * 3 + 1]);
+            sums[row] = checkMac(row + 1, sum + products[row * 3 + 2]);
+        }
+
+        setMacAndIr(1, sums[0], shift, lm);
+        setMacAndIr(2, sums[1], shift, lm);
+        setMac(3, sums[2], shift);
+
+        // IR3 saturation flag is checked against "MAC3 SAR 12" whatever sf is,
+        // while the value itself is saturated from MAC3
+        const int64_t z = sums[2] >> 12;
+        if (z < -0x8000 || z > 0x7fff)
+        {
+            m_flag |= FLAG_IR_SATURATED[3];
+        }
+        m_ir[3] = static_cast<int16_t>(std::clamp<int64_t>(m_mac[3], lm ? 0 : -0x8000, 0x7fff));
+
+        pushSZ(z);
+
+        const int64_t hDivSz = divide();
+        const int64_t sx = hDivSz * m_ir[1] + m_ofx;
+        const int64_t sy = hDivSz * m_ir[2] + m_ofy;
+        checkMac0(sx);
+        checkMac0(sy);
+        pushSXY(sx >> 16, sy >> 16);
+
+        if (last)
+        {
+            const int64_t depth = hDivSz * m_dqa + m_dqb;
+            setMac0(depth);
+            setIr0(depth >> 12);
+        }
+    }
+
+    // NCLIP : normal clipping (winding of the screen XY FIFO)
+    void GTE::opNCLIP()
+    {
+        const int64_t value =
+            static_cast<int64_t>(m_sx[0]) * m_sy[1] + static_cast<int64_t>(m_sx[1]) * m_sy[2] + static_cast<int64_t>(m_sx[2]) * m_sy[0] -
+            static_cast<int64_t>(m_sx[0]) * m_sy[2] - static_cast<int64_t>(m_sx[1]) * m_sy[0] - static_cast<int64_t>(m_sx[2]) * m_sy[1];
+        setMac0(value);
+    }
+
+    // OP : outer product of the rotation matrix diagonal with IR
+    void GTE::opOP(uint8_t shift, bool lm)
+    {
+        const int64_t d1 = m_rotation[0];
+        const int64_t d2 = m_rotation[4];
+        const int64_t d3 = m_rotation[8];
+
+        setMacAndIr(1, m_ir[3] * d2 - m_ir[2] * d3, shift, lm);
+        setMacAndIr(2, m_ir[1] * d3 - m_ir[3] * d1, shift, lm);
+        setMacAndIr(3, m_ir[2] * d1 - m_ir[1] * d2, shift, lm);
+    }
+
+    // DPCS/DPCT : depth cueing of a color
+    void GTE::opDPCS(const GTEColor& color, uint8_t shift, bool lm)
+    {
+        interpolateColor(static_cast<int64_t>(color[0]) << 16, static_cast<int64_t>(color[1]) << 16, static_cast<int64_t>(color[2]) << 16, shift, lm);
+        pushColorFromMac();
+    }
+
+    // INTPL : interpolation of IR and far color
+    void GTE::opINTPL(uint8_t shift, bool lm)
+    {
+        interpolateColor(static_cast<int64_t>(m_ir[1]) << 12, static_cast<int64_t>(m_ir[2]) << 12, static_cast<int64_t>(m_ir[3]) << 12, shift, lm);
+        pushColorFromMac();
+    }
+
+    // MVMVA : matrix * vector + translation, with all the hardware selection quirks
+    void GTE::opMVMVA(GTECommand command)
+    {
+        const uint8_t shift = command.bit.sf ? 12 : 0;
+        const bool lm = command.bit.lm;
+
+        GTEMatrix matrix{};
+        switch (command.bit.matrix)
+        {
+        case 0: matrix = m_rotation; break;
+        case 1: matrix = m_lightSource; break;
+        case 2: matrix = m_lightColor; break;
+        default:
+            // Garbage matrix built from RGBC, IR0 and rotation elements
+            matrix[0] = static_cast<int16_t>(-(m_rgbc[0] << 4));
+            matrix[1] = static_cast<int16_t>(m_rgbc[0] << 4);
+            matrix[2] = m_ir[0];
+            matrix[3] = matrix[4] = matrix[5] = m_rotation[2];
+            matrix[6] = matrix[7] = matrix[8] = m_rotation[4];
+            break;
+        }
+
+        const GTEVector vector = command.bit.vector == 3 ? irVector() : m_v[command.bit.vector];
+
+        static const std::array<int32_t, 3> noTranslation{};
+        switch (command.bit.translation)
+        {
+        case 0: multiplyMatrixVector(matrix, vector, m_translation, shift, lm); break;
+        case 1: multiplyMatrixVector(matrix, vector, m_backgroundColor, shift, lm); break;
+        case 2:
+        {
+            // Far color translation is bugged : the first column only affects the flags
+            std::array<int32_t, 9> products;
+            multiplyElements(matrix, vector, products);
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                const int64_t partial = checkMac(row + 1, (static_cast<int64_t>(m_farColor[row]) << 12) + products[row * 3]);
+                setIr(row + 1, partial >> shift, false);
+
+                const int64_t sum = checkMac(row + 1, products[row * 3 + 1]);
+                setMacAndIr(row + 1, checkMac(row + 1, sum + products[row * 3 + 2]), shift, lm);
+            }
+            break;
+        }
+        default: multiplyMatrixVector(matrix, vector, noTranslation, shift, lm); break;
+        }
+    }
+
+    // NCS/NCT : normal color
+    void GTE::opNCS(uint32_t vectorIndex, uint8_t shift, bool lm)
+    {
+        multiplyMatrixVector(m_lightSource, m_v[vectorIndex], { 0, 0, 0 }, shift, lm);
+        multiplyMatrixVector(m_lightColor, irVector(), m_backgroundColor, shift, lm);
+        pushColorFromMac();
+    }
+
+    // NCCS/NCCT : normal color color
+    void GTE::opNCCS(uint32_t vectorIndex, uint8_t shift, bool lm)
+    {
+        multiplyMatrixVector(m_lightSource, m_v[vectorIndex], { 0, 0, 0 }, shift, lm);
+        multiplyMatrixVector(m_lightColor, irVector(), m_backgroundColor, shift, lm);
+        multiplyLightColor(shift, lm);
+        pushColorFromMac();
+    }
+
+    // NCDS/NCDT : normal color depth cue
+    void GTE::opNCDS(uint32_t vectorIndex, uint8_t shift, bool lm)
+    {
+        multiplyMatrixVector(m_lightSource, m_v[vectorIndex], { 0, 0, 0 }, shift, lm);
+        multiplyMatrixVector(m_lightColor, irVector(), m_backgroundColor, shift, lm);
+        interpolateColor((static_cast<int64_t>(m_rgbc[0]) * m_ir[1]) << 4,
+                         (static_cast<int64_t>(m_rgbc[1]) * m_ir[2]) << 4,
+                         (static_cast<int64_t>(m_rgbc[2]) * m_ir[3]) << 4, shift, lm);
+        pushColorFromMac();
+    }
+
+    // CC : color color
+    void GTE::opCC(uint8_t shift, bool lm)
+    {
+        multiplyMatrixVector(m_lightColor, irVector(), m_backgroundColor, shift, lm);
+        multiplyLightColor(shift, lm);
+        pushColorFromMac();
+    }
+
+    // CDP : color depth cue
+    void GTE::opCDP(uint8_t shift, bool lm)
+    {
+        multiplyMatrixVector(m_lightColor, irVector(), m_backgroundColor, shift, lm);
+        interpolateColor((static_cast<int64_t>(m_rgbc[0]) * m_ir[1]) << 4,
+                         (static_cast<int64_t>(m_rgbc[1]) * m_ir[2]) << 4,
+                         (static_cast<int64_t>(m_rgbc[2]) * m_ir[3]) << 4, shift, lm);
+        pushColorFromMac();
+    }
+
+    // SQR : square of IR
+    void GTE::opSQR(uint8_t shift, bool lm)
+    {
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            setMacAndIr(i, static_cast<int64_t>(m_ir[i]) * m_ir[i], shift, lm);
+        }
+    }
+
+    // DCPL : depth cue color light
+    void GTE::opDCPL(uint8_t shift, bool lm)
+    {
+        interpolateColor((static_cast<int64_t>(m_rgbc[0]) * m_ir[1]) << 4,
+                         (static_cast<int64_t>(m_rgbc[1]) * m_ir[2]) << 4,
+                         (static_cast<int64_t>(m_rgbc[2]) * m_ir[3]) << 4, shift, lm);
+        pushColorFromMac();
+    }
+
+    // AVSZ3 : average of three Z values, for ordering tables
+    void GTE::opAVSZ3()
+    {
+        const int64_t value = static_cast<int64_t>(m_zsf3) * (m_sz[1] + m_sz[2] + m_sz[3]);
+        setMac0(value);
+        setOtz(value >> 12);
+    }
+
+    // AVSZ4 : average of four Z values
+    void GTE::opAVSZ4()
+    {
+        const int64_t value = static_cast<int64_t>(m_zsf4) * (m_sz[0] + m_sz[1] + m_sz[2] + m_sz[3]);
+        setMac0(value);
+        setOtz(value >> 12);
+    }
+
+    // GPF : general purpose interpolation
+    void GTE::opGPF(uint8_t shift, bool lm)
+    {
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            setMacAndIr(i, static_cast<int64_t>(m_ir[i]) * m_ir[0], shift, lm);
+        }
+        pushColorFromMac();
+    }
+
+    // GPL : general purpose interpolation with base
+    void GTE::opGPL(uint8_t shift, bool lm)
+    {
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            const int64_t base = static_cast<int64_t>(m_mac[i]) * (int64_t(1) << shift);
+            setMacAndIr(i, base + static_cast<int64_t>(m_ir[i]) * m_ir[0], shift, lm);
+        }
+        pushColorFromMac();
+    }
+
+    // [MAC1, MAC2, MAC3] = (translation * 0x1000 + matrix * vector) SAR shift, IR = MAC
+    void GTE::multiplyMatrixVector(const GTEMatrix& matrix, const GTEVector& vector, const std::array<int32_t, 3>& translation, uint8_t shift, bool lm)
+    {
+        std::array<int32_t, 9> products;
+        multiplyElements(matrix, vector, products);
+
+        for (uint32_t row = 0; row < 3; ++row)
+        {
+            int64_t sum = checkMac(row + 1, (static_cast<int64_t>(translation[row]) << 12) + products[row * 3]);
+            sum = checkMac(row + 1, sum + products[row * 3 + 1]);
+            sum = checkMac(row + 1, sum + products[row * 3 + 2]);
+            setMacAndIr(row + 1, sum, shift, lm);
+        }
+    }
+
+    // [MAC1, MAC2, MAC3] = ([R, G, B] * IR SHL 4) SAR shift, IR = MAC
+    void GTE::multiplyLightColor(uint8_t shift, bool lm)
+    {
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            setMacAndIr(i, (static_cast<int64_t>(m_rgbc[i - 1]) * m_ir[i]) << 4, shift, lm);
+        }
+    }
+
+    // Moves MAC towards the far color by IR0 :
+    // IR = ((FC SHL 12) - MAC) SAR shift, MAC = (IR * IR0 + MAC) SAR shift, IR = MAC
+    void GTE::interpolateColor(int64_t mac1, int64_t mac2, int64_t mac3, uint8_t shift, bool lm)
+    {
+        const std::array<int64_t, 3> macs = { mac1, mac2, mac3 };
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            setMacAndIr(i, (static_cast<int64_t>(m_farColor[i - 1]) << 12) - macs[i - 1], shift, false);
+        }
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            setMacAndIr(i, static_cast<int64_t>(m_ir[i]) * m_ir[0] + macs[i - 1], shift, lm);
+        }
+    }
+
+    // H / SZ3 in 1.16 fixed point, using the same reciprocal approximation as the hardware
+    uint32_t GTE::divide()
+    {
+        const uint32_t h = m_h;
+        const uint32_t sz3 = m_sz[3];
+
+        if (h >= sz3 * 2)
+        {
+            m_flag |= FLAG_DIVIDE_OVERFLOW;
+            return 0x1ffff;
+        }
+
+        const uint32_t leadingZeros = countLeadingZeros16(static_cast<uint16_t>(sz3));
+        const uint64_t n = static_cast<uint64_t>(h) << leadingZeros;
+        uint32_t d = sz3 << leadingZeros;
+        const uint32_t u = UNR_TABLE[(d - 0x7fc0) >> 7] + 0x101;
+        d = (0x2000080 - (d * u)) >> 8;
+        d = (0x0000080 + (d * u)) >> 8;
+
+        return static_cast<uint32_t>(std::min<uint64_t>(0x1ffff, ((n * d) + 0x8000) >> 16));
+    }
+
+    // Flags 44 bit overflows of MAC1-3 intermediate results, which wrap on hardware
+    int64_t GTE::checkMac(uint32_t index, int64_t value)
+    {
+        if (value > MAC_MAX)
+        {
+            m_flag |= FLAG_MAC_POSITIVE_OVERFLOW[index];
+        }
+        else if (value < MAC_MIN)
+        {
+            m_flag |= FLAG_MAC_NEGATIVE_OVERFLOW[index];
+        }
+        return static_cast<int64_t>(static_cast<uint64_t>(value) << 20) >> 20;
+    }
+
+    void GTE::setMac(uint32_t index, int64_t value, uint8_t shift)
+    {
+        checkMac(index, value);
+        m_mac[index] = static_cast<int32_t>(value >> shift);
+    }
+
+    void GTE::setMacAndIr(uint32_t index, int64_t value, uint8_t shift, bool lm)
+    {
+        checkMac(index, value);
+        value >>= shift;
+        m_mac[index] = static_cast<int32_t>(value);
+        setIr(index, value, lm);
+    }
+
+    void GTE::setIr(uint32_t index, int64_t value, bool lm)
+    {
+        const int64_t min = lm ? 0 : -0x8000;
+        if (value < min || value > 0x7fff)
+        {
+            m_flag |= FLAG_IR_SATURATED[index];
+            value = std::clamp<int64_t>(value, min, 0x7fff);
+        }
+        m_ir[index] = static_cast<int16_t>(value);
+    }
+
+    void GTE::setMac0(int64_t value)
+    {
+        checkMac0(value);
+        m_mac[0] = static_cast<int32_t>(value);
+    }
+
+    void GTE::checkMac0(int64_t value)
+    {
+        if (value > INT32_MAX)
+        {
+            m_flag |= FLAG_MAC_POSITIVE_OVERFLOW[0];
+        }
+        else if (value < INT32_MIN)
+        {
+            m_flag |= FLAG_MAC_NEGATIVE_OVERFLOW[0];
+        }
+    }
+
+    void GTE::setIr0(int64_t value)
+    {
+        if (value < 0 || value > 0x1000)
+        {
+            m_flag |= FLAG_IR_SATURATED[0];
+            value = std::clamp<int64_t>(value, 0, 0x1000);
+        }
+        m_ir[0] = static_cast<int16_t>(value);
+    }
+
+    void GTE::setOtz(int64_t value)
+    {
+        if (value < 0 || value > 0xffff)
+        {
+            m_flag |= FLAG_SZ3_OTZ_SATURATED;
+            value = std::clamp<int64_t>(value, 0, 0xffff);
+        }
+        m_otz = static_cast<uint16_t>(value);
+    }
+
+    void GTE::pushSZ(int64_t value)
+    {
+        if (value < 0 || value > 0xffff)
+        {
+            m_flag |= FLAG_SZ3_OTZ_SATURATED;
+            value = std::clamp<int64_t>(value, 0, 0xffff);
+        }
+        m_sz[0] = m_sz[1];
+        m_sz[1] = m_sz[2];
+        m_sz[2] = m_sz[3];
+        m_sz[3] = static_cast<uint16_t>(value);
+    }
+
+    void GTE::pushSXY(int64_t x, int64_t y)
+    {
+        if (x < -0x400 || x > 0x3ff)
+        {
+            m_flag |= FLAG_SX2_SATURATED;
+            x = std::clamp<int64_t>(x, -0x400, 0x3ff);
+        }
+        if (y < -0x400 || y > 0x3ff)
+        {
+            m_flag |= FLAG_SY2_SATURATED;
+            y = std::clamp<int64_t>(y, -0x400, 0x3ff);
+        }
+        m_sx[0] = m_sx[1];
+        m_sx[1] = m_sx[2];
+        m_sx[2] = static_cast<int16_t>(x);
+        m_sy[0] = m_sy[1];
+        m_sy[1] = m_sy[2];
+        m_sy[2] = static_cast<int16_t>(y);
+    }
+
+    void GTE::pushColorFromMac()
+    {
+        GTEColor color;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            int32_t value = m_mac[i + 1] >> 4;
+            if (value < 0 || value > 0xff)
+            {
+                m_flag |= FLAG_COLOR_SATURATED[i];
+                value = std::clamp(value, 0, 0xff);
+            }
+            color[i] = static_cast<uint8_t>(value);
+        }
+        color[3] = m_rgbc[3];
+
+        m_rgb[0] = m_rgb[1];
+        m_rgb[1] = m_rgb[2];
+        m_rgb[2] = color;
+    }
+}
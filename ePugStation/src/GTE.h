@@ -0,0 +1,160 @@
+#ifndef E_PUG_STATION_GTE
+#define E_PUG_STATION_GTE
+
+#include "SaveState.h"
+
+#include <cstdint>
+#include <array>
+
+namespace ePugStation
+{
+    // See http://problemkaputt.de/psx-spx.htm#geometrytransformationenginegte for definitions
+    enum class GTEOp : unsigned
+    {
+        RTPS = 0x01,
+        NCLIP = 0x06,
+        OP = 0x0c,
+        DPCS = 0x10,
+        INTPL = 0x11,
+        MVMVA = 0x12,
+        NCDS = 0x13,
+        CDP = 0x14,
+        NCDT = 0x16,
+        NCCS = 0x1b,
+        CC = 0x1c,
+        NCS = 0x1e,
+        NCT = 0x20,
+        SQR = 0x28,
+        DCPL = 0x29,
+        DPCT = 0x2a,
+        AVSZ3 = 0x2d,
+        AVSZ4 = 0x2e,
+        RTPT = 0x30,
+        GPF = 0x3d,
+        GPL = 0x3e,
+        NCCT = 0x3f
+    };
+
+    struct GTECommand
+    {
+        GTECommand(uint32_t command) : value(command) {}
+
+        union
+        {
+            uint32_t value;
+            struct {
+                GTEOp opcode : 6;           // [5:0]
+                unsigned : 4;               // [9:6]
+                unsigned lm : 1;            // [10] Saturate IR to 0..7fff instead of -8000..7fff
+                unsigned : 2;               // [12:11]
+                unsigned translation : 2;   // [14:13] MVMVA : TR, BK, FC (bugged), none
+                unsigned vector : 2;        // [16:15] MVMVA : V0, V1, V2, IR
+                unsigned matrix : 2;        // [18:17] MVMVA : RT, LLM, LCM, garbage
+                unsigned sf : 1;            // [19] Shift results by 12
+                unsigned : 12;
+            } bit;
+        };
+    };
+
+    // 3x3 matrix stored row major, padded so a whole row set fits vector loads
+    using GTEMatrix = std::array<int16_t, 16>;
+    // Matrix replicated for the three RTPT vertices, padded to four 8 lanes vectors
+    using GTEBatchMatrix = std::array<int16_t, 32>;
+    using GTEVector = std::array<int16_t, 3>;
+    using GTEColor = std::array<uint8_t, 4>;
+
+    class GTE
+    {
+    public:
+        GTE();
+        ~GTE() = default;
+
+        // cop2r0-31, MFC2/MTC2/LWC2/SWC2
+        uint32_t getData(uint32_t index) const;
+        void setData(uint32_t index, uint32_t value);
+
+        // cop2r32-63, CFC2/CTC2
+        uint32_t getControl(uint32_t index) const;
+        void setControl(uint32_t index, uint32_t value);
+
+        void execute(uint32_t command);
+
+        void saveState(SaveStateWriter& writer) const;
+        void loadState(SaveStateReader& reader);
+
+    private:
+        // Data registers
+        std::array<GTEVector, 3> m_v;       // r0-5 : V0, V1, V2
+        GTEColor m_rgbc;                    // r6
+        uint16_t m_otz;                     // r7
+        std::array<int16_t, 4> m_ir;        // r8-11 : IR0, IR1, IR2, IR3
+        std::array<int16_t, 3> m_sx;        // r12-14 : screen XY FIFO (r15 pushes)
+        std::array<int16_t, 3> m_sy;
+        std::array<uint16_t, 4> m_sz;       // r16-19 : screen Z FIFO
+        std::array<GTEColor, 3> m_rgb;      // r20-22 : color FIFO
+        uint32_t m_res1;                    // r23
+        std::array<int32_t, 4> m_mac;       // r24-27 : MAC0, MAC1, MAC2, MAC3
+        uint32_t m_lzcs;                    // r30
+        uint32_t m_lzcr;                    // r31
+
+        // Control registers
+        GTEMatrix m_rotation;                       // r32-36
+        GTEBatchMatrix m_rotationBatch;             // RT replicated for RTPT
+        std::array<int32_t, 3> m_translation;       // r37-39
+        GTEMatrix m_lightSource;                    // r40-44
+        std::array<int32_t, 3> m_backgroundColor;   // r45-47
+        GTEMatrix m_lightColor;                     // r48-52
+        std::array<int32_t, 3> m_farColor;          // r53-55
+        int32_t m_ofx;                              // r56
+        int32_t m_ofy;                              // r57
+        uint16_t m_h;                               // r58
+        int16_t m_dqa;                              // r59
+        int32_t m_dqb;                              // r60
+        int16_t m_zsf3;                             // r61
+        int16_t m_zsf4;                             // r62
+        uint32_t m_flag;                            // r63
+
+        // Commands
+        void opRTPS(uint32_t vectorIndex, uint8_t shift, bool lm, bool last);
+        void opRTPT(uint8_t shift, bool lm);
+        void opNCLIP();
+        void opOP(uint8_t shift, bool lm);
+        void opDPCS(const GTEColor& color, uint8_t shift, bool lm);
+        void opINTPL(uint8_t shift, bool lm);
+        void opMVMVA(GTECommand command);
+        void opNCS(uint32_t vectorIndex, uint8_t shift, bool lm);
+        void opNCCS(uint32_t vectorIndex, uint8_t shift, bool lm);
+        void opNCDS(uint32_t vectorIndex, uint8_t shift, bool lm);
+        void opCC(uint8_t shift, bool lm);
+        void opCDP(uint8_t shift, bool lm);
+        void opSQR(uint8_t shift, bool lm);
+        void opDCPL(uint8_t shift, bool lm);
+        void opAVSZ3();
+        void opAVSZ4();
+        void opGPF(uint8_t shift, bool lm);
+        void opGPL(uint8_t shift, bool lm);
+
+        // Shared steps
+        void projectVertex(const int32_t* products, uint8_t shift, bool lm, bool last);
+        void multiplyMatrixVector(const GTEMatrix& matrix, const GTEVector& vector, const std::array<int32_t, 3>& translation, uint8_t shift, bool lm);
+        void multiplyLightColor(uint8_t shift, bool lm);
+        void interpolateColor(int64_t mac1, int64_t mac2, int64_t mac3, uint8_t shift, bool lm);
+        uint32_t divide();
+
+        // Result writers, setting FLAG on saturation/overflow
+        int64_t checkMac(uint32_t index, int64_t value);
+        void setMac(uint32_t index, int64_t value, uint8_t shift);
+        void setMacAndIr(uint32_t index, int64_t value, uint8_t shift, bool lm);
+        void setIr(uint32_t index, int64_t value, bool lm);
+        void setMac0(int64_t value);
+        void checkMac0(int64_t value);
+        void setIr0(int64_t value);
+        void setOtz(int64_t value);
+        void pushSZ(int64_t value);
+        void pushSXY(int64_t x, int64_t y);
+        void pushColorFromMac();
+
+        GTEVector irVector() const { return { m_ir[1], m_ir[2], m_ir[3] }; }
+    };
+}
+#endif
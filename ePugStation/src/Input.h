@@ -0,0 +1,35 @@
+#ifndef E_PUG_STATION_INPUT
+#define E_PUG_STATION_INPUT
+
+#include <cstdint>
+
+namespace ePugStation
+{
+   // Digital pad buttons, in the order of the pad protocol bits. Set while held.
+   enum PadButton : uint16_t
+   {
+      PAD_SELECT = 1 << 0,
+      PAD_L3 = 1 << 1,
+      PAD_R3 = 1 << 2,
+      PAD_START = 1 << 3,
+      PAD_UP = 1 << 4,
+      PAD_RIGHT = 1 << 5,
+      PAD_DOWN = 1 << 6,
+      PAD_LEFT = 1 << 7,
+      PAD_L2 = 1 << 8,
+      PAD_R2 = 1 << 9,
+      PAD_L1 = 1 << 10,
+      PAD_R1 = 1 << 11,
+      PAD_TRIANGLE = 1 << 12,
+      PAD_CIRCLE = 1 << 13,
+      PAD_CROSS = 1 << 14,
+      PAD_SQUARE = 1 << 15
+   };
+
+   // Everything the host feeds the machine during a frame
+   struct FrameInput
+   {
+      uint16_t padButtons = 0;
+   };
+}
+#endif
@@ -1,8 +1,13 @@
 #include "Interconnect.h"
 #include "Constants.h"
+#include "DMAUtilities.h"
+#include "DirtyPages.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include "Utils.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace
@@ -18,11 +23,32 @@ namespace
         0xFFFFFFFF, 0xFFFFFFFF
     };
 
+    // Ready to receive commands, VRAM to CPU and DMA blocks
+    constexpr uint32_t GPUSTAT_HEADLESS = 0x1c000000;
+
     uint32_t maskRegion(uint32_t address)
     {
         return address & REGION_MASK[address >> 29];
     }
 
+    // Counted before dispatch, unhandled addresses count as MMIO. Plain counters, published once per
+    // frame, since a metric update on every fetch would slow the CPU down noticeably.
+    void countAccess(std::array<uint64_t, 3>& counts, uint32_t physicalAddress)
+    {
+        if (ePugStation::RAM_RANGE_PHYSICAL.contains(physicalAddress))
+        {
+            ++counts[0];
+        }
+        else if (ePugStation::BIOS_RANGE_PHYSICAL.contains(physicalAddress))
+        {
+            ++counts[1];
+        }
+        else
+        {
+            ++counts[2];
+        }
+    }
+
     template<typename DATA_TYPE>
     constexpr int getDataShiftCount()
     {
@@ -40,18 +66,22 @@ namespace
         }
     }
 
+    // Offsets are rounded down to the access size. memcpy compiles to a single move and does not
+    // alias the byte arrays through wider pointers.
     template<typename DATA_TYPE>
-    void store(const uint8_t* data, uint32_t offset, DATA_TYPE value)
+    void store(uint8_t* data, uint32_t offset, DATA_TYPE value)
     {
         constexpr int shiftCount = getDataShiftCount<DATA_TYPE>();
-        ((DATA_TYPE*)data)[offset >> shiftCount] = value;
+        std::memcpy(data + ((offset >> shiftCount) << shiftCount), &value, sizeof(DATA_TYPE));
     }
 
     template<typename DATA_TYPE>
-        DATA_TYPE load(const uint8_t* data, uint32_t offset)
+    DATA_TYPE load(const uint8_t* data, uint32_t offset)
     {
         constexpr int shiftCount = getDataShiftCount<DATA_TYPE>();
-        return static_cast<DATA_TYPE>(((DATA_TYPE*)data)[offset >> shiftCount]);
+        DATA_TYPE value;
+        std::memcpy(&value, data + ((offset >> shiftCount) << shiftCount), sizeof(DATA_TYPE));
+        return value;
     }
 }
 
@@ -60,20 +90,21 @@ namespace ePugStation
     uint8_t Interconnect::load8(uint32_t address) const
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (BIOS_RANGE_PHYSICAL.contains(physicalAddress))
         {
             uint32_t offset = BIOS_RANGE_PHYSICAL.offset(physicalAddress);
-            return load<uint8_t>(m_bios.data(), offset);
+            return load<uint8_t>(m_biosData, offset);
         }
         else if (EXPANSION_1_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled EXPANSION 1 load8, returning 0xFF...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled EXPANSION 1 load8, returning 0xFF...");
             return 0xFF;
         }
         else if (EXPANSION_2_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled EXPANSION 2 load8, returning 0xFF...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled EXPANSION 2 load8, returning 0xFF...");
             return 0xFF;
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
@@ -83,7 +114,7 @@ namespace ePugStation
         }
         else if (CDROM_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled CDROM load 8, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled CDROM load 8, ignoring...");
             return 0;
         }
         else
@@ -95,10 +126,11 @@ namespace ePugStation
     uint16_t Interconnect::load16(uint32_t address) const
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (SPU_RANGE.contains(physicalAddress))
         {
-            //std::cout << "Unhandled SPU load16, ignoring...\n";
+            //E_PUG_STATION_LOG(Warning, Memory, "Unhandled SPU load16, ignoring...");
             return 0;
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
@@ -108,8 +140,7 @@ namespace ePugStation
         }
         else if (INTERRUPT_CONTROL_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled INTERRUPT CONTROL load16, ignoring...\n";
-            return 0;
+            return static_cast<uint16_t>(getInterruptControlReg(physicalAddress));
         }
         else
         {
@@ -120,11 +151,12 @@ namespace ePugStation
     uint32_t Interconnect::load32(uint32_t address) const
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (BIOS_RANGE_PHYSICAL.contains(physicalAddress))
         {
             uint32_t offset = BIOS_RANGE_PHYSICAL.offset(physicalAddress);
-            return load<uint32_t>(m_bios.data(), offset);
+            return load<uint32_t>(m_biosData, offset);
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
         {
@@ -133,8 +165,7 @@ namespace ePugStation
         }
         else if (INTERRUPT_CONTROL_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled INTERRUPT CONTROL load32, ignoring...\n";
-            return 0;
+            return getInterruptControlReg(physicalAddress);
         }
         else if (DMA_RANGE.contains(physicalAddress))
         {
@@ -145,39 +176,66 @@ namespace ePugStation
             auto offset = GPU_RANGE.offset(physicalAddress);
             if (offset == 0)
             {
-                std::cout << "GPUREAD not implemented, ignoring...\n";
+                E_PUG_STATION_LOG(Warning, Memory, "GPUREAD not implemented, ignoring...");
                 return 0;
             }
+            else if (m_gpu)
+            {
+                return m_gpu->getGPUStat().value;
+            }
             else
             {
-                return m_gpu.getGPUStat().value;
+                return GPUSTAT_HEADLESS;
             }
         }
         else if (TIMERS_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled TIMERS load32, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled TIMERS load32, ignoring...");
             return 0;
         }
 
         throw std::runtime_error("unhandled interconnect load address..." + std::to_string(physicalAddress));
     }
 
+    uint32_t Interconnect::fetch32(uint32_t address, Opcode& opcode) const
+    {
+        uint32_t physicalAddress = maskRegion(address);
+        if (BIOS_RANGE_PHYSICAL.contains(physicalAddress) && m_biosData == m_bios->data())
+        {
+            countAccess(m_accessCounts, physicalAddress);
+            uint32_t offset = BIOS_RANGE_PHYSICAL.offset(physicalAddress);
+            uint32_t word = load<uint32_t>(m_biosData, offset);
+            opcode = (offset & 3) == 0 ? m_decodedBios->getOpcode(offset) : decodeOpcode(word);
+            return word;
+        }
+
+        uint32_t word = load32(address);
+        opcode = decodeOpcode(word);
+        return word;
+    }
+
     void Interconnect::store8(uint32_t address, uint8_t value)
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (EXPANSION_2_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled EXPANSION 2 store8, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled EXPANSION 2 store8, ignoring...");
+        }
+        else if (BIOS_RANGE_PHYSICAL.contains(physicalAddress))
+        {
+            storeBios<uint8_t>(BIOS_RANGE_PHYSICAL.offset(physicalAddress), value);
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
         {
             uint32_t offset = RAM_RANGE_PHYSICAL.offset(physicalAddress);
             store<uint8_t>(m_ram.data(), offset, value);
+            m_dirtyRam.mark(offset >> DIRTY_PAGE_SHIFT);
         }
         else if (CDROM_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled CDROM store8, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled CDROM store8, ignoring...");
         }
         else
         {
@@ -188,23 +246,29 @@ namespace ePugStation
     void Interconnect::store16(uint32_t address, uint16_t value)
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (SPU_RANGE.contains(physicalAddress))
         {
-            //std::cout << "Unhandled SPU store16, ignoring...\n";
+            //E_PUG_STATION_LOG(Warning, Memory, "Unhandled SPU store16, ignoring...");
+        }
+        else if (BIOS_RANGE_PHYSICAL.contains(physicalAddress))
+        {
+            storeBios<uint16_t>(BIOS_RANGE_PHYSICAL.offset(physicalAddress), value);
         }
         else if (TIMERS_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled TIMERS store16, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled TIMERS store16, ignoring...");
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
         {
             uint32_t offset = RAM_RANGE_PHYSICAL.offset(physicalAddress);
             store<uint16_t>(m_ram.data(), offset, value);
+            m_dirtyRam.mark(offset >> DIRTY_PAGE_SHIFT);
         }
         else if (INTERRUPT_CONTROL_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled INTERRUPT CONTROL store16, ignoring...\n";
+            setInterruptControlReg(physicalAddress, value);
         }
         else
         {
@@ -215,16 +279,17 @@ namespace ePugStation
     void Interconnect::store32(uint32_t address, uint32_t value)
     {
         uint32_t physicalAddress = maskRegion(address);
+        countAccess(m_accessCounts, physicalAddress);
 
         if (BIOS_RANGE_PHYSICAL.contains(physicalAddress))
         {
-            uint32_t offset = BIOS_RANGE_PHYSICAL.offset(physicalAddress);
-            store<uint32_t>(m_bios.data(), offset, value);
+            storeBios<uint32_t>(BIOS_RANGE_PHYSICAL.offset(physicalAddress), value);
         }
         else if (RAM_RANGE_PHYSICAL.contains(physicalAddress))
         {
             uint32_t offset = RAM_RANGE_PHYSICAL.offset(physicalAddress);
             store<uint32_t>(m_ram.data(), offset, value);
+            m_dirtyRam.mark(offset >> DIRTY_PAGE_SHIFT);
         }
         else if (MEM_CONTROL_RANGE.contains(physicalAddress))
         {
@@ -239,20 +304,20 @@ namespace ePugStation
             }
             else
             {
-                std::cout << "Unhandled MEM_CONTROL store, ignoring...\n";
+                E_PUG_STATION_LOG(Warning, Memory, "Unhandled MEM_CONTROL store, ignoring...");
             }
         }
         else if (RAM_SIZE_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled RAM_SIZE store, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled RAM_SIZE store, ignoring...");
         }
         else if (CACHE_CONTROL_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled CACHE_CONTROL store, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled CACHE_CONTROL store, ignoring...");
         }
         else if (INTERRUPT_CONTROL_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled INTERRUPT_CONTROL store, ignoring...\n";
+            setInterruptControlReg(physicalAddress, value);
         }
         else if (DMA_RANGE.contains(physicalAddress))
         {
@@ -261,18 +326,22 @@ namespace ePugStation
         else if (GPU_RANGE.contains(physicalAddress))
         {
             uint32_t offset = GPU_RANGE.offset(physicalAddress);
+            if (!m_gpu)
+            {
+                return;
+            }
             if (offset == 0)
             {
-                m_gpu.setGP0Command(value);
+                m_gpu->setGP0Command(value);
             }
             else
             {
-                m_gpu.setGP1Command(value);
+                m_gpu->setGP1Command(value);
             }
         }
         else if (TIMERS_RANGE.contains(physicalAddress))
         {
-            std::cout << "Unhandled TIMERS store, ignoring...\n";
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled TIMERS store, ignoring...");
         }
         else
         {
@@ -280,6 +349,286 @@ namespace ePugStation
         }
     }
 
+    void Interconnect::publishMetrics()
+    {
+        countMetric(Metric::RamAccesses, m_accessCounts[0]);
+        countMetric(Metric::BiosAccesses, m_accessCounts[1]);
+        countMetric(Metric::MmioAccesses, m_accessCounts[2]);
+        m_accessCounts.fill(0);
+    }
+
+    void Interconnect::saveRegisters(SaveStateWriter& writer) const
+    {
+        m_dma.saveState(writer);
+        m_interruptControl.saveState(writer);
+        writer.write(m_gpu != nullptr);
+        if (m_gpu)
+        {
+            m_gpu->saveState(writer);
+        }
+    }
+
+    void Interconnect::loadRegisters(SaveStateReader& reader)
+    {
+        m_dma.loadState(reader);
+        m_interruptControl.loadState(reader);
+        if (reader.read<bool>())
+        {
+            if (!m_gpu)
+            {
+                throw std::runtime_error("Save state has GPU state but the interconnect has no GPU");
+            }
+            m_gpu->loadState(reader);
+        }
+        else if (m_gpu)
+        {
+            E_PUG_STATION_LOG(Warning, SaveState, "Save state has no GPU state, keeping current GPU state...");
+        }
+    }
+
+    void Interconnect::skipRegisters(SaveStateReader& reader) const
+    {
+        reader.view(savedSize([this](SaveStateWriter& writer)
+        {
+            m_dma.saveState(writer);
+            m_interruptControl.saveState(writer);
+        }));
+        if (reader.read<bool>())
+        {
+            if (!m_gpu)
+            {
+                throw std::runtime_error("Save state has GPU state but the interconnect has no GPU");
+            }
+            m_gpu->skipState(reader);
+        }
+    }
+
+    void Interconnect::saveState(SaveStateWriter& writer) const
+    {
+        saveRegisters(writer);
+        writer.writeBlock(m_ram.data(), m_ram.size());
+
+        writer.write(!m_biosOverlay.empty());
+        if (!m_biosOverlay.empty())
+        {
+            writer.writeBlock(m_biosOverlay.data(), m_biosOverlay.size());
+        }
+
+        writer.write(m_gpu != nullptr);
+        if (m_gpu)
+        {
+            writer.writeBlock(m_gpu->getVramData(), VRAM_SIZE_16_bit * sizeof(uint16_t));
+        }
+    }
+
+    void Interconnect::loadState(SaveStateReader& reader)
+    {
+        loadRegisters(reader);
+        reader.readBlock(m_ram.data(), m_ram.size());
+        // Every page may differ now, for the trackers that do not clear on load
+        m_dirtyRam.markAll();
+        m_dirtyBios.markAll();
+
+        if (reader.read<bool>())
+        {
+            m_biosOverlay.resize(BIOS_MEMORY_SIZE);
+            reader.readBlock(m_biosOverlay.data(), m_biosOverlay.size());
+            m_biosData = m_biosOverlay.data();
+        }
+        else
+        {
+            m_biosOverlay.clear();
+            m_biosData = m_bios->data();
+        }
+
+        // GPU presence was already checked with the registers
+        if (reader.read<bool>() && m_gpu)
+        {
+            m_gpu->restoreVram(reader.view(VRAM_SIZE_16_bit * sizeof(uint16_t)));
+        }
+    }
+
+    void Interconnect::skipState(SaveStateReader& reader) const
+    {
+        skipRegisters(reader);
+        reader.view(m_ram.size());
+        if (reader.read<bool>())
+        {
+            reader.view(BIOS_MEMORY_SIZE);
+        }
+        if (reader.read<bool>() && m_gpu)
+        {
+            reader.view(VRAM_SIZE_16_bit * sizeof(uint16_t));
+        }
+    }
+
+    uint32_t Interconnect::getPageCount(MemoryRegion region) const
+    {
+        switch (region)
+        {
+        case MemoryRegion::RAM: return RAM_SIZE / DIRTY_PAGE_SIZE;
+        case MemoryRegion::BIOS: return BIOS_MEMORY_SIZE / DIRTY_PAGE_SIZE;
+        case MemoryRegion::VRAM: return m_gpu ? VRAM_TILE_COUNT : 0;
+        default:
+            throw std::runtime_error("Unknown memory region : " + std::to_string(static_cast<uint32_t>(region)));
+        }
+    }
+
+    void Interconnect::readPage(MemoryRegion region, uint32_t page, uint8_t* data) const
+    {
+        if (page >= getPageCount(region))
+        {
+            throw std::runtime_error("Invalid page : " + std::to_string(page));
+        }
+
+        switch (region)
+        {
+        case MemoryRegion::RAM: std::memcpy(data, m_ram.data() + page * DIRTY_PAGE_SIZE, DIRTY_PAGE_SIZE); break;
+        case MemoryRegion::BIOS: std::memcpy(data, m_biosData + page * DIRTY_PAGE_SIZE, DIRTY_PAGE_SIZE); break;
+        case MemoryRegion::VRAM: m_gpu->readVramTile(page, data); break;
+        }
+    }
+
+    void Interconnect::writePage(MemoryRegion region, uint32_t page, const uint8_t* data)
+    {
+        if (page >= getPageCount(region))
+        {
+            throw std::runtime_error("Invalid page : " + std::to_string(page));
+        }
+
+        switch (region)
+        {
+        case MemoryRegion::RAM:
+            std::memcpy(m_ram.data() + page * DIRTY_PAGE_SIZE, data, DIRTY_PAGE_SIZE);
+            m_dirtyRam.mark(page);
+            break;
+        case MemoryRegion::BIOS:
+            if (m_biosOverlay.empty())
+            {
+                m_biosOverlay.assign(m_bios->data(), m_bios->data() + m_bios->size());
+                m_biosData = m_biosOverlay.data();
+            }
+            std::memcpy(m_biosOverlay.data() + page * DIRTY_PAGE_SIZE, data, DIRTY_PAGE_SIZE);
+            m_dirtyBios.mark(page);
+            break;
+        case MemoryRegion::VRAM:
+            m_gpu->writeVramTile(page, data);
+            break;
+        }
+    }
+
+    void Interconnect::commitPages()
+    {
+        if (m_gpu)
+        {
+            m_gpu->uploadVram();
+        }
+    }
+
+    void Interconnect::clearDirtyState(DirtyTracker tracker)
+    {
+        m_dirtyRam.clear(tracker);
+        m_dirtyBios.clear(tracker);
+        if (m_gpu)
+        {
+            m_gpu->clearDirtyState(tracker);
+        }
+    }
+
+    void Interconnect::writeRam(uint32_t address, const uint8_t* data, uint32_t size)
+    {
+        uint32_t offset = address & (RAM_SIZE - 1);
+        if (size > RAM_SIZE - offset)
+        {
+            throw std::runtime_error("RAM range out of bounds");
+        }
+        std::memcpy(m_ram.data() + offset, data, size);
+        markRamDirty(offset, size);
+    }
+
+    void Interconnect::clearRam(uint32_t address, uint32_t size)
+    {
+        uint32_t offset = address & (RAM_SIZE - 1);
+        if (size > RAM_SIZE - offset)
+        {
+            throw std::runtime_error("RAM range out of bounds");
+        }
+        std::memset(m_ram.data() + offset, 0, size);
+        markRamDirty(offset, size);
+    }
+
+    void Interconnect::markRamDirty(uint32_t address, uint32_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        if (size >= RAM_SIZE)
+        {
+            m_dirtyRam.markAll();
+            return;
+        }
+
+        // RAM wraps, like the DMA addresses
+        uint32_t first = address & (RAM_SIZE - 1);
+        uint32_t last = (first + size - 1) & (RAM_SIZE - 1);
+        if (last < first)
+        {
+            m_dirtyRam.markRange(first >> DIRTY_PAGE_SHIFT, (RAM_SIZE - 1) >> DIRTY_PAGE_SHIFT);
+            m_dirtyRam.markRange(0, last >> DIRTY_PAGE_SHIFT);
+        }
+        else
+        {
+            m_dirtyRam.markRange(first >> DIRTY_PAGE_SHIFT, last >> DIRTY_PAGE_SHIFT);
+        }
+    }
+
+    template<typename T>
+    void Interconnect::storeBios(uint32_t offset, T value)
+    {
+        if (m_biosWritePolicy == BiosWritePolicy::Reject)
+        {
+            E_PUG_STATION_LOG(Warning, Memory, "Unhandled BIOS store, ignoring...");
+            return;
+        }
+
+        if (m_biosOverlay.empty())
+        {
+            m_biosOverlay.assign(m_bios->data(), m_bios->data() + m_bios->size());
+            m_biosData = m_biosOverlay.data();
+        }
+        store<T>(m_biosOverlay.data(), offset, value);
+        m_dirtyBios.mark(offset >> DIRTY_PAGE_SHIFT);
+    }
+
+    uint32_t Interconnect::getInterruptControlReg(uint32_t address) const
+    {
+        uint32_t offset = INTERRUPT_CONTROL_RANGE.offset(address);
+        switch (offset)
+        {
+        case 0: return m_interruptControl.getStatus();
+        case 4: return m_interruptControl.getMask();
+        case 2:
+        case 6: return 0; // Upper halfwords are unused
+        default:
+            throw std::runtime_error("Unhandled INTERRUPT CONTROL access at offset : " + std::to_string(offset));
+        }
+    }
+
+    void Interconnect::setInterruptControlReg(uint32_t address, uint32_t value)
+    {
+        uint32_t offset = INTERRUPT_CONTROL_RANGE.offset(address);
+        switch (offset)
+        {
+        case 0: m_interruptControl.acknowledge(value); break;
+        case 4: m_interruptControl.setMask(value); break;
+        case 2:
+        case 6: break; // Upper halfwords are unused
+        default:
+            throw std::runtime_error("Unhandled INTERRUPT CONTROL access at offset : " + std::to_string(offset));
+        }
+    }
+
     uint32_t Interconnect::getDMAReg(uint32_t address) const
     {
         uint32_t offset = DMA_RANGE.offset(address);
@@ -344,16 +693,15 @@ namespace ePugStation
             throw std::runtime_error("Linked list only implemented for GPU");
         }
 
+        DMAPort* port = m_dmaPorts[index];
         while(true)
         {
             uint32_t header = load<uint32_t>(m_ram.data(), address);
             uint32_t transferSize = header >> 24;
-            while (transferSize > 0)
+            countDmaWords(index, transferSize + 1);
+            if (transferSize > 0 && port != nullptr)
             {
-                address = (address + 4) & 0x1ffffc;
-                uint32_t command =  load<uint32_t>(m_ram.data(), address);
-                m_gpu.setGP0Command(command);
-                --transferSize;
+                transferFromRam(port, address + 4, 4, transferSize);
             }
 
             // Hardware seems to only check MSB (To validate)
@@ -363,7 +711,10 @@ namespace ePugStation
             }
             address = header & 0x1ffffc;
         }
-        m_dma.finalizeCopy(index);
+        if (m_dma.finalizeCopy(index))
+        {
+            m_interruptControl.request(InterruptRequest::DMA);
+        }
     }
 
     void Interconnect::blockCopyDMA(uint32_t index)
@@ -374,38 +725,82 @@ namespace ePugStation
         uint32_t address = channel.baseAddress;
         uint32_t transferSize = channel.getTransferSize();
 
-        while (transferSize > 0)
+        if (index == 6 && channel.control.bit.isFromRam == DMATransferDirection::ToRam)
+        {
+            // Ordering table clear, address step is forced backward on this channel
+            clearOrderingTable(reinterpret_cast<uint32_t*>(m_ram.data()), address, transferSize);
+            countDmaWords(index, transferSize);
+            markRamDirty(address - (transferSize - 1) * 4, std::min(transferSize, RAM_SIZE / 4) * 4);
+        }
+        else if (DMAPort* port = m_dmaPorts[index])
         {
-            uint32_t currentAddress = address & 0x1ffffc; // Masking hypothesis : RAM address wraps and two LSB are ignored
-            uint32_t srcWord = 0;
+            // Sync mode 1 sizes reach 4G words, more than one lap of RAM is meaningless for a device
+            if (transferSize > RAM_SIZE / 4)
+            {
+                E_PUG_STATION_LOG(Warning, DMA, "DMA channel %u transfer of %u words is larger than RAM, truncating...", index, transferSize);
+                transferSize = RAM_SIZE / 4;
+            }
+            countDmaWords(index, transferSize);
             if (channel.control.bit.isFromRam == DMATransferDirection::ToRam)
             {
-                if (index == 6)
-                {
-                    srcWord = transferSize == 1 ? 0xffffff : ((address - 4) & 0x1ffffc);
-                }
-                else
-                {
-                    throw std::runtime_error("Unhandled DMA channel port");
-                }
-                store<uint32_t>(m_ram.data(), currentAddress, srcWord);
+                transferToRam(port, address, increment, transferSize);
             }
             else
             {
-                srcWord = load<uint32_t>(m_ram.data(), currentAddress);
-                if (index == 2)
-                {
-                    m_gpu.setGP0Command(srcWord);
-                }
-                else
-                {
-                    throw std::runtime_error("Unhandled DMA channel port");
-                }
+                transferFromRam(port, address, increment, transferSize);
             }
+        }
+        else
+        {
+            E_PUG_STATION_LOG(Warning, DMA, "Unhandled DMA channel port %u, ignoring...", index);
+        }
+
+        if (m_dma.finalizeCopy(index))
+        {
+            m_interruptControl.request(InterruptRequest::DMA);
+        }
+    }
+
+    void Interconnect::transferToRam(DMAPort* port, uint32_t address, int32_t increment, uint32_t transferSize)
+    {
+        uint32_t offset = address & 0x1ffffc; // Masking hypothesis : RAM address wraps and two LSB are ignored
+
+        // Fast path, device writes straight into RAM, aligned for word access
+        if (increment > 0 && transferSize <= (RAM_SIZE - offset) / 4)
+        {
+            port->readWords(reinterpret_cast<uint32_t*>(m_ram.data()) + (offset >> 2), transferSize);
+            markRamDirty(offset, transferSize * 4);
+            return;
+        }
+
+        m_dmaBuffer.resize(transferSize);
+        port->readWords(m_dmaBuffer.data(), transferSize);
+        for (uint32_t word : m_dmaBuffer)
+        {
+            store<uint32_t>(m_ram.data(), address & 0x1ffffc, word);
+            m_dirtyRam.mark((address & 0x1ffffc) >> DIRTY_PAGE_SHIFT);
+            address += increment;
+        }
+    }
+
+    void Interconnect::transferFromRam(DMAPort* port, uint32_t address, int32_t increment, uint32_t transferSize)
+    {
+        uint32_t offset = address & 0x1ffffc;
+
+        // Fast path, device reads straight from RAM, aligned for word access
+        if (increment > 0 && transferSize <= (RAM_SIZE - offset) / 4)
+        {
+            port->writeWords(reinterpret_cast<const uint32_t*>(m_ram.data()) + (offset >> 2), transferSize);
+            return;
+        }
+
+        m_dmaBuffer.resize(transferSize);
+        for (uint32_t& word : m_dmaBuffer)
+        {
+            word = load<uint32_t>(m_ram.data(), address & 0x1ffffc);
             address += increment;
-            --transferSize;
         }
-        m_dma.finalizeCopy(index);
+        port->writeWords(m_dmaBuffer.data(), transferSize);
     }
 
     void Interconnect::setDMAReg(uint32_t address, uint32_t value)
@@ -445,30 +840,13 @@ namespace ePugStation
             }
             else if (minor == 4)
             {
-                m_dma.setInterrupt(value);
+                if (m_dma.setInterrupt(value))
+                {
+                    m_interruptControl.request(InterruptRequest::DMA);
+                }
                 return;
             }
         }
         throw std::runtime_error("Unhandled DMA access");
     }
-
-    void Interconnect::loadBios()
-    {
-        std::ifstream biosFile(PATH_TO_BIOS, std::ios::binary | std::ios::ate);
-        if (!biosFile.is_open())
-        {
-            throw std::runtime_error("Failed to open BIOS file");
-        }
-
-        auto length = biosFile.tellg();
-        biosFile.seekg(0, std::ios::beg);
-
-        if (!biosFile.read((char*)m_bios.data(), length))
-        {
-            if (!biosFile.eof())
-            {
-                throw std::runtime_error("BIOS file size mismatch... Not at eof");
-            }
-        }
-    }
 }
\ No newline at end of file
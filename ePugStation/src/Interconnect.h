@@ -1,23 +1,53 @@
 #ifndef E_PUG_STATION_INTERCONNECT
 #define E_PUG_STATION_INTERCONNECT
 
+#include "BiosImage.h"
+#include "CodeCache.h"
 #include "DMA.h"
+#include "DMAPort.h"
+#include "DirtyPages.h"
 #include "GPU.h"
-#include "SDLContext.h"
+#include "InterruptControl.h"
+#include "SaveState.h"
 
 #include <array>
+#include <memory>
+#include <vector>
 
 namespace ePugStation
 {
+   // What a store on the BIOS range does, the image itself is never written
+   enum class BiosWritePolicy
+   {
+      Reject,      // Ignored, like the hardware ROM
+      CopyOnWrite  // First store copies the image into a private overlay (BIOS patches)
+   };
+
+   // Memory tracked in DIRTY_PAGE_SIZE pages for delta snapshots and rewind
+   enum class MemoryRegion : uint32_t
+   {
+      RAM = 0,
+      BIOS = 1, // Reads the image until an overlay exists, writing a page creates it
+      VRAM = 2  // 64x32 pixels tiles, no pages without a GPU
+   };
+
+   constexpr std::array<MemoryRegion, 3> MEMORY_REGIONS = { MemoryRegion::RAM, MemoryRegion::BIOS, MemoryRegion::VRAM };
+
    class Interconnect
    {
    public:
       Interconnect() = delete;
-      Interconnect(SDLContext* context)
-         : m_gpu(context)
+      // Without a GPU, GP0/GP1 writes are dropped and GPUSTAT always reports ready (headless runs)
+      Interconnect(std::shared_ptr<const BiosImage> bios, std::unique_ptr<GPU> gpu = nullptr)
+         : m_bios(std::move(bios)),
+           m_biosData(m_bios->data()),
+           m_decodedBios(getDecodedBios(*m_bios)),
+           m_biosWritePolicy(BiosWritePolicy::Reject),
+           m_gpu(std::move(gpu))
       {
-         loadBios();
          m_ram.fill(0xac);
+         m_dmaPorts.fill(nullptr);
+         setDMAPort(DMAChannelPort::GPU, m_gpu.get());
       };
       ~Interconnect() = default;
 
@@ -28,20 +58,94 @@ namespace ePugStation
       void store16(uint32_t address, uint16_t value);
       void store32(uint32_t address, uint32_t value);
 
+      // Instruction fetch, a load32 that also gives the opcode. Unpatched BIOS words come predecoded
+      // from the shared cache, everything else is decoded on the fly.
+      uint32_t fetch32(uint32_t address, Opcode& opcode) const;
+
+      void setBiosWritePolicy(BiosWritePolicy policy) { m_biosWritePolicy = policy; }
+
+      bool isInterruptPending() const { return m_interruptControl.isPending(); }
+      // End of the displayed frame
+      void requestVBlank() { m_interruptControl.request(InterruptRequest::VBlank); }
+
+      const uint8_t* getRamData() const { return m_ram.data(); }
+      // Direct RAM access for loaders, "address" in any segment, throws when the range wraps
+      void writeRam(uint32_t address, const uint8_t* data, uint32_t size);
+      void clearRam(uint32_t address, uint32_t size);
+      const GPU* getGPU() const { return m_gpu.get(); }
+      GPU* getGPU() { return m_gpu.get(); }
+      // NTSC when headless
+      VideoMode getVideoMode() const { return m_gpu ? m_gpu->getVideoMode() : VideoMode::NTSC; }
+
+      // DMA, interrupts and GPU registers, everything but the memory content
+      void saveRegisters(SaveStateWriter& writer) const;
+      void loadRegisters(SaveStateReader& reader);
+      void skipRegisters(SaveStateReader& reader) const;
+
+      // Registers, RAM, BIOS overlay and VRAM
+      void saveState(SaveStateWriter& writer) const;
+      void loadState(SaveStateReader& reader);
+      // Same checks as loadState, without applying anything
+      void skipState(SaveStateReader& reader) const;
+
+      // Page access, writePage marks the page dirty and commitPages() must follow a batch of writes
+      uint32_t getPageCount(MemoryRegion region) const;
+      void readPage(MemoryRegion region, uint32_t page, uint8_t* data) const;
+      void writePage(MemoryRegion region, uint32_t page, const uint8_t* data);
+      void commitPages();
+
+      // Calls "function(page)" for every page written since clearDirtyState(tracker)
+      template<typename FUNCTION>
+      void forEachDirtyPage(DirtyTracker tracker, MemoryRegion region, FUNCTION&& function) const
+      {
+         switch (region)
+         {
+         case MemoryRegion::RAM: m_dirtyRam.forEach(tracker, function); break;
+         case MemoryRegion::BIOS: m_dirtyBios.forEach(tracker, function); break;
+         case MemoryRegion::VRAM: if (m_gpu) { m_gpu->getDirtyVramTiles().forEach(tracker, function); } break;
+         }
+      }
+      void clearDirtyState(DirtyTracker tracker);
+
+      // Adds the loads and stores per region since the last call to the metrics
+      void publishMetrics();
+
+      // Plug a device on a DMA channel, nullptr leaves the channel unhandled
+      void setDMAPort(DMAChannelPort channel, DMAPort* port) { m_dmaPorts[static_cast<uint32_t>(channel)] = port; }
+
    private:
+      uint32_t getInterruptControlReg(uint32_t address) const;
+      void setInterruptControlReg(uint32_t address, uint32_t value);
+
       uint32_t getDMAReg(uint32_t address) const;
       void setDMAReg(uint32_t address, uint32_t value);
 
       void executeDMATransfer(uint32_t index);
       void blockCopyDMA(uint32_t index);
       void linkedListCopyDMA(uint32_t index);
+      void transferToRam(DMAPort* port, uint32_t address, int32_t increment, uint32_t transferSize);
+      void transferFromRam(DMAPort* port, uint32_t address, int32_t increment, uint32_t transferSize);
 
-      void loadBios();
+      // Any access width, only called from this class stores
+      template<typename T>
+      void storeBios(uint32_t offset, T value);
+      void markRamDirty(uint32_t address, uint32_t size);
 
-      std::array<uint8_t, BIOS_MEMORY_SIZE> m_bios;
-      std::array<uint8_t, RAM_SIZE> m_ram;
+      std::shared_ptr<const BiosImage> m_bios;
+      const uint8_t* m_biosData; // Image or overlay once written
+      std::shared_ptr<const DecodedCode> m_decodedBios; // Of the image, not of the overlay
+      BiosWritePolicy m_biosWritePolicy;
+      std::vector<uint8_t> m_biosOverlay;
+      DirtyPages<BIOS_MEMORY_SIZE / DIRTY_PAGE_SIZE> m_dirtyBios;
+      alignas(32) std::array<uint8_t, RAM_SIZE> m_ram; // Word access for the DMA fast paths, SIMD for OT clears
+      DirtyPages<RAM_SIZE / DIRTY_PAGE_SIZE> m_dirtyRam;
       DMA m_dma;
-      GPU m_gpu;
+      std::unique_ptr<GPU> m_gpu;
+      InterruptControl m_interruptControl;
+
+      std::array<DMAPort*, DMA_CHANNEL_COUNT> m_dmaPorts;
+      std::vector<uint32_t> m_dmaBuffer; // Staging for transfers that are not contiguous in RAM
+      mutable std::array<uint64_t, 3> m_accessCounts{}; // RAM, BIOS and MMIO
    };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef E_PUG_STATION_INTERRUPT_CONTROL
+#define E_PUG_STATION_INTERRUPT_CONTROL
+
+#include "SaveState.h"
+
+#include <cstdint>
+
+namespace ePugStation
+{
+    // See http://problemkaputt.de/psx-spx.htm#interrupts for definitions
+    enum class InterruptRequest : unsigned
+    {
+        VBlank = 0,
+        GPU = 1,
+        CDROM = 2,
+        DMA = 3,
+        Timer0 = 4,
+        Timer1 = 5,
+        Timer2 = 6,
+        Controller = 7,
+        SIO = 8,
+        SPU = 9,
+        Lightpen = 10
+    };
+
+    constexpr uint32_t INTERRUPT_REGISTERS_MASK = 0x7ff;
+
+    class InterruptControl
+    {
+    public:
+        InterruptControl() : m_status(0), m_mask(0) {}
+        ~InterruptControl() = default;
+
+        // I_STAT : 0x1f801070
+        uint32_t getStatus() const { return m_status; }
+        // Writing 0 acknowledges the bit, writing 1 leaves it unchanged
+        void acknowledge(uint32_t value) { m_status &= value; }
+
+        // I_MASK : 0x1f801074
+        uint32_t getMask() const { return m_mask; }
+        void setMask(uint32_t value) { m_mask = value & INTERRUPT_REGISTERS_MASK; }
+
+        void request(InterruptRequest interrupt) { m_status |= (1 << static_cast<uint32_t>(interrupt)); }
+
+        // Drives cop0 cause IP bit 2 (hardware interrupt)
+        bool isPending() const { return (m_status & m_mask) != 0; }
+
+        void saveState(SaveStateWriter& writer) const
+        {
+            writer.write(m_status);
+            writer.write(m_mask);
+        }
+
+        void loadState(SaveStateReader& reader)
+        {
+            m_status = reader.read<uint32_t>();
+            m_mask = reader.read<uint32_t>();
+        }
+
+    private:
+        uint32_t m_status;
+        uint32_t m_mask;
+    };
+}
+#endif
@@ -0,0 +1,87 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ePugStation
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path)
+    {
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Failed to open file : " + path);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(m_file);
+            throw std::runtime_error("Failed to get file size : " + path);
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view == nullptr)
+        {
+            if (m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+            }
+            CloseHandle(m_file);
+            throw std::runtime_error("Failed to map file : " + path);
+        }
+        m_data = static_cast<const uint8_t*>(view);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+    }
+#else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Failed to open file : " + path);
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to get file size : " + path);
+        }
+        m_size = static_cast<size_t>(fileStat.st_size);
+
+        // The mapping keeps its own reference on the file
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+        {
+            throw std::runtime_error("Failed to map file : " + path);
+        }
+        m_data = static_cast<const uint8_t*>(view);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+}
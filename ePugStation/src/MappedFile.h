@@ -0,0 +1,33 @@
+#ifndef E_PUG_STATION_MAPPED_FILE
+#define E_PUG_STATION_MAPPED_FILE
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace ePugStation
+{
+    // Read only view of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    public:
+        // Throws when the file is missing, empty or cannot be mapped
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;    // HANDLE
+        void* m_mapping = nullptr; // HANDLE
+#endif
+    };
+}
+#endif
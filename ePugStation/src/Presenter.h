@@ -0,0 +1,63 @@
+#ifndef E_PUG_STATION_PRESENTER
+#define E_PUG_STATION_PRESENTER
+
+#include "DisplayFrame.h"
+#include "SDLContext.h"
+#include "Timeline.h"
+
+#include "glad/glad.h"
+#include "SDL2/SDL.h"
+
+namespace ePugStation
+{
+   // Shows the frames of the emulation thread on the window, owns the presentation GL context
+   class Presenter
+   {
+   public:
+      Presenter() = delete;
+      // Makes the presentation context current on the calling thread
+      Presenter(SDLContext* context)
+         : m_window(context->getWindow())
+      {
+         context->makePresentationContextCurrent();
+         SDL_GL_SetSwapInterval(1); // Vsync only stalls this thread
+
+         glGenTextures(1, &m_texture);
+         glBindTexture(GL_TEXTURE_2D, m_texture);
+         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, DisplayFrame::WIDTH, DisplayFrame::HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+         glGenFramebuffers(1, &m_framebuffer);
+         glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+      }
+
+      ~Presenter()
+      {
+         glDeleteFramebuffers(1, &m_framebuffer);
+         glDeleteTextures(1, &m_texture);
+      }
+
+      Presenter(const Presenter&) = delete;
+      Presenter& operator=(const Presenter&) = delete;
+
+      void present(const DisplayFrame& frame)
+      {
+         {
+            E_PUG_STATION_TIMER("Frame upload");
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, DisplayFrame::WIDTH, DisplayFrame::HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+            glBlitFramebuffer(0, 0, DisplayFrame::WIDTH, DisplayFrame::HEIGHT, 0, 0, DisplayFrame::WIDTH, DisplayFrame::HEIGHT,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+         }
+         E_PUG_STATION_TIMER("Swap");
+         SDL_GL_SwapWindow(m_window);
+      }
+
+   private:
+      SDL_Window* m_window;
+      GLuint m_texture;
+      GLuint m_framebuffer;
+   };
+}
+
+#endif
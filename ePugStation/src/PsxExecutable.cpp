@@ -0,0 +1,65 @@
+#include "PsxExecutable.h"
+#include "Constants.h"
+#include "MappedFile.h"
+#include "SaveState.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    using namespace ePugStation;
+
+    constexpr char PSX_EXE_MAGIC[] = "PS-X EXE";
+
+    // Executables are linked in KUSEG, KSEG0 or KSEG1, all mirroring the first 2MB
+    void checkFitsInRam(uint32_t address, uint32_t size, const char* section)
+    {
+        uint32_t offset = address & 0x1fffffff;
+        if (offset >= RAM_SIZE || size > RAM_SIZE - offset)
+        {
+            throw std::runtime_error(std::string("PS-X EXE ") + section + " does not fit in RAM");
+        }
+    }
+}
+
+namespace ePugStation
+{
+    std::shared_ptr<const PsxExecutable> PsxExecutable::fromFile(const std::string& path)
+    {
+        MappedFile file(path);
+        return fromMemory(file.data(), file.size());
+    }
+
+    std::shared_ptr<const PsxExecutable> PsxExecutable::fromMemory(const uint8_t* data, size_t size)
+    {
+        if (size < PSX_EXE_HEADER_SIZE || std::memcmp(data, PSX_EXE_MAGIC, sizeof(PSX_EXE_MAGIC) - 1) != 0)
+        {
+            throw std::runtime_error("Not a PS-X EXE");
+        }
+
+        // 0x10 pc, gp, text address and size, 0x28 bss address and size, stack base and offset
+        SaveStateReader reader(data + 0x10, PSX_EXE_HEADER_SIZE - 0x10);
+        auto executable = std::shared_ptr<PsxExecutable>(new PsxExecutable());
+        executable->m_entryPoint = reader.read<uint32_t>();
+        executable->m_globalPointer = reader.read<uint32_t>();
+        executable->m_textAddress = reader.read<uint32_t>();
+        uint32_t textSize = reader.read<uint32_t>();
+        reader.view(2 * sizeof(uint32_t)); // Data section, unused
+        executable->m_bssAddress = reader.read<uint32_t>();
+        executable->m_bssSize = reader.read<uint32_t>();
+        uint32_t stackBase = reader.read<uint32_t>();
+        uint32_t stackOffset = reader.read<uint32_t>();
+        executable->m_stackPointer = stackBase ? stackBase + stackOffset : PSX_EXE_DEFAULT_STACK;
+
+        if (textSize > size - PSX_EXE_HEADER_SIZE)
+        {
+            throw std::runtime_error("PS-X EXE truncated, text of " + std::to_string(textSize) + " bytes");
+        }
+        checkFitsInRam(executable->m_textAddress, textSize, "text");
+        checkFitsInRam(executable->m_bssAddress, executable->m_bssSize, "bss");
+
+        executable->m_text.assign(data + PSX_EXE_HEADER_SIZE, data + PSX_EXE_HEADER_SIZE + textSize);
+        return executable;
+    }
+}
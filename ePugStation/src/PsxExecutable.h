@@ -0,0 +1,49 @@
+#ifndef E_PUG_STATION_PSX_EXECUTABLE
+#define E_PUG_STATION_PSX_EXECUTABLE
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    // 2KB header, then the text copied to RAM as is
+    constexpr size_t PSX_EXE_HEADER_SIZE = 0x800;
+    // The BIOS jumps there once the kernel is initialized, to start the shell
+    constexpr uint32_t BIOS_SHELL_ENTRY_POINT = 0x80030000;
+    // Top of RAM minus 16, where the BIOS puts the stack of executables with a stack base of 0
+    constexpr uint32_t PSX_EXE_DEFAULT_STACK = 0x801ffff0;
+
+    // PS-X EXE file, parsed once and immutable, shareable between emulators
+    class PsxExecutable
+    {
+    public:
+        // Throw when the header is invalid or the text does not fit in RAM
+        static std::shared_ptr<const PsxExecutable> fromFile(const std::string& path);
+        static std::shared_ptr<const PsxExecutable> fromMemory(const uint8_t* data, size_t size);
+
+        uint32_t getEntryPoint() const { return m_entryPoint; }
+        uint32_t getGlobalPointer() const { return m_globalPointer; }
+        uint32_t getTextAddress() const { return m_textAddress; }
+        const std::vector<uint8_t>& getText() const { return m_text; }
+        // Zero filled on load
+        uint32_t getBssAddress() const { return m_bssAddress; }
+        uint32_t getBssSize() const { return m_bssSize; }
+        // PSX_EXE_DEFAULT_STACK when the header stack base is 0, so direct loads never run with sp = 0
+        uint32_t getStackPointer() const { return m_stackPointer; }
+
+    private:
+        PsxExecutable() = default;
+
+        uint32_t m_entryPoint = 0;
+        uint32_t m_globalPointer = 0;
+        uint32_t m_textAddress = 0;
+        std::vector<uint8_t> m_text;
+        uint32_t m_bssAddress = 0;
+        uint32_t m_bssSize = 0;
+        uint32_t m_stackPointer = 0;
+    };
+}
+#endif
@@ -0,0 +1,166 @@
+#include "Replay.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "Metrics.h"
+#include "SaveState.h"
+#include "Timeline.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace ePugStation
+{
+    namespace
+    {
+        template<bool IS_TRACING, bool IS_PROFILING>
+        void runInstructions(CPU& cpu, uint32_t instructions, TraceRecorder* trace, Profiler* profiler)
+        {
+            for (uint32_t i = 0; i < instructions; ++i)
+            {
+                cpu.runNextInstruction<IS_TRACING, IS_PROFILING>(trace, profiler);
+            }
+        }
+    }
+
+    void runFrame(CPU& cpu, Interconnect& interconnect, const FrameInput& /*input*/, uint32_t instructions,
+                  TraceRecorder* trace, Profiler* profiler)
+    {
+        // No pad port yet, the input is recorded so replays stay valid once it is read
+        E_PUG_STATION_TIMER("Emulation");
+        if (trace && profiler)
+        {
+            runInstructions<true, true>(cpu, instructions, trace, profiler);
+        }
+        else if (trace)
+        {
+            runInstructions<true, false>(cpu, instructions, trace, profiler);
+        }
+        else if (profiler)
+        {
+            runInstructions<false, true>(cpu, instructions, trace, profiler);
+        }
+        else
+        {
+            runInstructions<false, false>(cpu, instructions, trace, profiler);
+        }
+        interconnect.requestVBlank();
+        countMetric(Metric::Instructions, instructions);
+        interconnect.publishMetrics();
+    }
+
+    void Replay::save(const std::string& path) const
+    {
+        std::vector<uint8_t> buffer;
+        SaveStateWriter writer(buffer);
+        writer.write(REPLAY_MAGIC);
+        writer.write(REPLAY_VERSION);
+        writer.write(instructionsPerFrame);
+        writer.write(static_cast<uint32_t>(snapshot.size()));
+        writer.writeBlock(snapshot.data(), snapshot.size());
+        writer.write(static_cast<uint32_t>(inputs.size()));
+        for (size_t frame = 0; frame < inputs.size(); ++frame)
+        {
+            writer.write(inputs[frame].padButtons);
+            writer.write(hashes[frame].ram);
+            writer.write(hashes[frame].vram);
+            writer.write(hashes[frame].display);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()))
+        {
+            throw std::runtime_error("Could not write replay : " + path);
+        }
+    }
+
+    Replay Replay::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open replay : " + path);
+        }
+        std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        SaveStateReader reader(buffer.data(), buffer.size());
+        if (reader.read<uint32_t>() != REPLAY_MAGIC)
+        {
+            throw std::runtime_error("Not a replay : " + path);
+        }
+        uint32_t version = reader.read<uint32_t>();
+        if (version != REPLAY_VERSION)
+        {
+            throw std::runtime_error("Unsupported replay version : " + std::to_string(version));
+        }
+
+        Replay replay;
+        replay.instructionsPerFrame = reader.read<uint32_t>();
+        // Sizes are checked against the file before allocating, a corrupted count must not reserve gigabytes
+        uint32_t snapshotSize = reader.read<uint32_t>();
+        if (snapshotSize > reader.remaining())
+        {
+            throw std::runtime_error("Replay snapshot truncated : " + path);
+        }
+        replay.snapshot.resize(snapshotSize);
+        reader.readBlock(replay.snapshot.data(), replay.snapshot.size());
+
+        uint32_t frameCount = reader.read<uint32_t>();
+        if (frameCount > reader.remaining() / REPLAY_FRAME_SIZE)
+        {
+            throw std::runtime_error("Replay frames truncated : " + path);
+        }
+        replay.inputs.resize(frameCount);
+        replay.hashes.resize(frameCount);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            replay.inputs[frame].padButtons = reader.read<uint16_t>();
+            replay.hashes[frame].ram = reader.read<uint32_t>();
+            replay.hashes[frame].vram = reader.read<uint32_t>();
+            replay.hashes[frame].display = reader.read<uint32_t>();
+        }
+        if (!reader.isAtEnd())
+        {
+            throw std::runtime_error("Replay has trailing data : " + path);
+        }
+        return replay;
+    }
+
+    ReplayRecorder::ReplayRecorder(const CPU& cpu, Interconnect& interconnect, uint32_t instructionsPerFrame)
+    {
+        m_replay.instructionsPerFrame = instructionsPerFrame;
+        saveState(cpu, interconnect, m_replay.snapshot);
+    }
+
+    void ReplayRecorder::runFrame(CPU& cpu, Interconnect& interconnect, const FrameInput& input, TraceRecorder* trace,
+                                  Profiler* profiler)
+    {
+        ePugStation::runFrame(cpu, interconnect, input, m_replay.instructionsPerFrame, trace, profiler);
+        m_replay.inputs.push_back(input);
+        m_replay.hashes.push_back(hashFrame(interconnect));
+    }
+
+    ReplayResult runReplay(const Replay& replay, CPU& cpu, Interconnect& interconnect,
+                           const std::function<void(uint32_t frame, const FrameHashes& hashes)>& onFrame,
+                           TraceRecorder* trace, Profiler* profiler)
+    {
+        loadState(cpu, interconnect, replay.snapshot.data(), replay.snapshot.size());
+
+        ReplayResult result;
+        for (uint32_t frame = 0; frame < replay.inputs.size(); ++frame)
+        {
+            runFrame(cpu, interconnect, replay.inputs[frame], replay.instructionsPerFrame, trace, profiler);
+            FrameHashes hashes = hashFrame(interconnect);
+            if (!result.firstMismatch && hashes != replay.hashes[frame])
+            {
+                result.firstMismatch = frame;
+            }
+            if (onFrame)
+            {
+                onFrame(frame, hashes);
+            }
+            ++result.frameCount;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef E_PUG_STATION_REPLAY
+#define E_PUG_STATION_REPLAY
+
+#include "FrameHash.h"
+#include "Input.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    class CPU;
+    class Interconnect;
+    class Profiler;
+    class TraceRecorder;
+
+    // Layout : magic, version, instructions per frame, starting snapshot, then input and hashes per frame.
+    // The machine only advances by instructions, so host timing needs no recording : the starting
+    // snapshot, the frame length and the input of every frame are enough for a bit identical rerun.
+    constexpr uint32_t REPLAY_MAGIC = 0x50525045; // "EPRP"
+    constexpr uint32_t REPLAY_VERSION = 3;
+    // Pad buttons and the three frame hashes
+    constexpr uint32_t REPLAY_FRAME_SIZE = sizeof(uint16_t) + 3 * sizeof(uint32_t);
+
+    // One frame of emulation with its input applied, ending on the VBlank interrupt, shared by live,
+    // recorded and replayed runs.
+    // Every instruction is recorded in "trace" and sampled by "profiler" when they are given.
+    void runFrame(CPU& cpu, Interconnect& interconnect, const FrameInput& input, uint32_t instructions,
+                  TraceRecorder* trace = nullptr, Profiler* profiler = nullptr);
+
+    struct Replay
+    {
+        uint32_t instructionsPerFrame = 0;
+        std::vector<uint8_t> snapshot;
+        std::vector<FrameInput> inputs;
+        std::vector<FrameHashes> hashes;
+
+        void save(const std::string& path) const;
+        static Replay load(const std::string& path);
+    };
+
+    class ReplayRecorder
+    {
+    public:
+        // Starts from a full save state of the current machine
+        ReplayRecorder(const CPU& cpu, Interconnect& interconnect, uint32_t instructionsPerFrame);
+
+        // Runs one frame and records its input and the resulting hashes
+        void runFrame(CPU& cpu, Interconnect& interconnect, const FrameInput& input, TraceRecorder* trace = nullptr,
+                      Profiler* profiler = nullptr);
+
+        const Replay& getReplay() const { return m_replay; }
+
+    private:
+        Replay m_replay;
+    };
+
+    struct ReplayResult
+    {
+        uint32_t frameCount = 0;
+        std::optional<uint32_t> firstMismatch; // First frame whose hashes differ from the recording
+    };
+
+    // Loads the starting snapshot and runs every frame unthrottled, without polling any host input.
+    // "onFrame" gets each frame hashes as they are computed.
+    ReplayResult runReplay(const Replay& replay, CPU& cpu, Interconnect& interconnect,
+                           const std::function<void(uint32_t frame, const FrameHashes& hashes)>& onFrame = nullptr,
+                           TraceRecorder* trace = nullptr, Profiler* profiler = nullptr);
+}
+#endif
@@ -0,0 +1,272 @@
+#include "RewindBuffer.h"
+#include "CPU.h"
+#include "SaveState.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Captures kept around for reuse, the emulation thread rarely gets more than one ahead
+    constexpr size_t MAX_FREE_CAPTURES = 4;
+}
+
+namespace ePugStation
+{
+    RewindBuffer::RewindBuffer(const CPU& cpu, Interconnect& interconnect, RewindConfig config)
+        : m_config(config),
+          m_framesSinceCapture(0),
+          m_memoryUsage(0),
+          m_isBusy(false),
+          m_isStopping(false)
+    {
+        if (m_config.captureInterval == 0)
+        {
+            throw std::runtime_error("Rewind capture interval must be at least 1 frame");
+        }
+        reset(cpu, interconnect);
+        m_worker = std::thread(&RewindBuffer::run, this);
+    }
+
+    RewindBuffer::~RewindBuffer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isStopping = true;
+        }
+        m_workAvailable.notify_one();
+        m_worker.join();
+    }
+
+    void RewindBuffer::reset(const CPU& cpu, Interconnect& interconnect)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        waitUntilIdle(lock);
+
+        for (MemoryRegion region : MEMORY_REGIONS)
+        {
+            uint32_t pageCount = interconnect.getPageCount(region);
+            auto& shadow = m_shadow[static_cast<uint32_t>(region)];
+            shadow.resize(size_t(pageCount) * DIRTY_PAGE_SIZE);
+            for (uint32_t page = 0; page < pageCount; ++page)
+            {
+                interconnect.readPage(region, page, shadow.data() + size_t(page) * DIRTY_PAGE_SIZE);
+            }
+        }
+
+        // Registers only, the shadow holds its memory
+        Frame baseline;
+        SaveStateWriter writer(baseline.registers);
+        cpu.saveState(writer);
+        interconnect.saveRegisters(writer);
+
+        m_frames.clear();
+        m_memoryUsage = baseline.size();
+        m_frames.push_back(std::move(baseline));
+
+        m_stalePages.clear();
+        m_framesSinceCapture = 0;
+        interconnect.clearDirtyState(DirtyTracker::Rewind);
+    }
+
+    void RewindBuffer::onFrame(const CPU& cpu, Interconnect& interconnect)
+    {
+        if (++m_framesSinceCapture < m_config.captureInterval)
+        {
+            return;
+        }
+        m_framesSinceCapture = 0;
+
+        Capture newCapture;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_freeCaptures.empty())
+            {
+                newCapture = std::move(m_freeCaptures.back());
+                m_freeCaptures.pop_back();
+            }
+        }
+
+        captureFrame(cpu, interconnect, newCapture);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingCaptures.push_back(std::move(newCapture));
+        }
+        m_workAvailable.notify_one();
+    }
+
+    bool RewindBuffer::rewind(CPU& cpu, Interconnect& interconnect)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            waitUntilIdle(lock);
+            if (m_frames.empty())
+            {
+                return false;
+            }
+            frame = std::move(m_frames.back());
+            m_frames.pop_back();
+            m_memoryUsage -= frame.size();
+        }
+
+        // The worker is idle and only this thread feeds it, the shadow is ours until the next capture.
+        // It holds the newest snapshot, which differs from the machine on dirty and stale pages only.
+        std::vector<PageId> pages = m_stalePages;
+        for (MemoryRegion region : MEMORY_REGIONS)
+        {
+            interconnect.forEachDirtyPage(DirtyTracker::Rewind, region, [&](uint32_t page) { pages.emplace_back(region, page); });
+        }
+        std::sort(pages.begin(), pages.end());
+        pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+        for (const PageId& page : pages)
+        {
+            interconnect.writePage(page.first, page.second, shadowPage(page));
+        }
+        interconnect.commitPages();
+
+        SaveStateReader reader(frame.registers.data(), frame.registers.size());
+        cpu.loadState(reader);
+        interconnect.loadRegisters(reader);
+
+        // Step the shadow back to the previous snapshot, the pages it changes are now stale
+        m_stalePages.clear();
+        applyDelta(frame);
+
+        m_framesSinceCapture = 0;
+        interconnect.clearDirtyState(DirtyTracker::Rewind);
+        return true;
+    }
+
+    size_t RewindBuffer::getFrameCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frames.size();
+    }
+
+    size_t RewindBuffer::getMemoryUsage() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_memoryUsage;
+    }
+
+    void RewindBuffer::captureFrame(const CPU& cpu, Interconnect& interconnect, Capture& capture)
+    {
+        capture.registers.clear();
+        SaveStateWriter writer(capture.registers);
+        cpu.saveState(writer);
+        interconnect.saveRegisters(writer);
+
+        capture.pages = m_stalePages;
+        for (MemoryRegion region : MEMORY_REGIONS)
+        {
+            interconnect.forEachDirtyPage(DirtyTracker::Rewind, region, [&](uint32_t page) { capture.pages.emplace_back(region, page); });
+        }
+        std::sort(capture.pages.begin(), capture.pages.end());
+        capture.pages.erase(std::unique(capture.pages.begin(), capture.pages.end()), capture.pages.end());
+
+        capture.pageData.resize(capture.pages.size() * DIRTY_PAGE_SIZE);
+        for (size_t i = 0; i < capture.pages.size(); ++i)
+        {
+            interconnect.readPage(capture.pages[i].first, capture.pages[i].second, capture.pageData.data() + i * DIRTY_PAGE_SIZE);
+        }
+
+        m_stalePages.clear();
+        interconnect.clearDirtyState(DirtyTracker::Rewind);
+    }
+
+    void RewindBuffer::run()
+    {
+        while (true)
+        {
+            Capture capture;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workAvailable.wait(lock, [this] { return m_isStopping || !m_pendingCaptures.empty(); });
+                if (m_pendingCaptures.empty())
+                {
+                    return;
+                }
+                capture = std::move(m_pendingCaptures.front());
+                m_pendingCaptures.pop_front();
+                m_isBusy = true;
+            }
+
+            Frame frame;
+            compressFrame(capture, frame);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_memoryUsage += frame.size();
+                m_frames.push_back(std::move(frame));
+                while (m_memoryUsage > m_config.memoryBudget && m_frames.size() > 1)
+                {
+                    m_memoryUsage -= m_frames.front().size();
+                    m_frames.pop_front();
+                }
+
+                if (m_freeCaptures.size() < MAX_FREE_CAPTURES)
+                {
+                    m_freeCaptures.push_back(std::move(capture));
+                }
+                m_isBusy = false;
+            }
+            m_idle.notify_all();
+        }
+    }
+
+    void RewindBuffer::compressFrame(const Capture& capture, Frame& frame)
+    {
+        frame.registers = capture.registers;
+
+        std::array<uint8_t, DIRTY_PAGE_SIZE> difference;
+        SaveStateWriter writer(frame.delta);
+        for (size_t i = 0; i < capture.pages.size(); ++i)
+        {
+            const uint8_t* page = capture.pageData.data() + i * DIRTY_PAGE_SIZE;
+            uint8_t* shadow = shadowPage(capture.pages[i]);
+            // Written but back to the same content, common for stack pages
+            if (std::memcmp(shadow, page, DIRTY_PAGE_SIZE) == 0)
+            {
+                continue;
+            }
+
+            for (uint32_t byte = 0; byte < DIRTY_PAGE_SIZE; ++byte)
+            {
+                difference[byte] = shadow[byte] ^ page[byte];
+            }
+            std::memcpy(shadow, page, DIRTY_PAGE_SIZE);
+
+            writer.write(capture.pages[i].first);
+            writer.write(capture.pages[i].second);
+            writer.writeCompressed(difference.data(), difference.size());
+        }
+    }
+
+    void RewindBuffer::applyDelta(const Frame& frame)
+    {
+        std::array<uint8_t, DIRTY_PAGE_SIZE> difference;
+        SaveStateReader reader(frame.delta.data(), frame.delta.size());
+        while (!reader.isAtEnd())
+        {
+            PageId page;
+            page.first = reader.read<MemoryRegion>();
+            page.second = reader.read<uint32_t>();
+            reader.readCompressed(difference.data(), difference.size());
+
+            uint8_t* shadow = shadowPage(page);
+            for (uint32_t byte = 0; byte < DIRTY_PAGE_SIZE; ++byte)
+            {
+                shadow[byte] ^= difference[byte];
+            }
+            m_stalePages.push_back(page);
+        }
+    }
+
+    void RewindBuffer::waitUntilIdle(std::unique_lock<std::mutex>& lock)
+    {
+        m_idle.wait(lock, [this] { return m_pendingCaptures.empty() && !m_isBusy; });
+    }
+}
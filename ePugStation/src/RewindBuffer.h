@@ -0,0 +1,98 @@
+#ifndef E_PUG_STATION_REWIND_BUFFER
+#define E_PUG_STATION_REWIND_BUFFER
+
+#include "Interconnect.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ePugStation
+{
+    class CPU;
+
+    struct RewindConfig
+    {
+        size_t memoryBudget = 64 * 1024 * 1024; // Compressed frames, the oldest are dropped past it
+        uint32_t captureInterval = 1;           // Frames between two snapshots
+    };
+
+    // Ring of per-frame snapshots, each one holding the registers and the pages changed since the
+    // previous snapshot, XORed against it and LZ4 compressed.
+    // The emulation thread only copies the dirty pages, XOR and compression run on a worker thread.
+    // XOR deltas apply both ways, so a full copy of the newest snapshot (the shadow) is enough to walk
+    // back frame by frame, and dropping the oldest frame costs nothing. The shadow is not in the budget.
+    // Uses its own dirty page tracker, save states taken or loaded in between are seen as page writes.
+    class RewindBuffer
+    {
+    public:
+        RewindBuffer(const CPU& cpu, Interconnect& interconnect, RewindConfig config = {});
+        ~RewindBuffer();
+
+        RewindBuffer(const RewindBuffer&) = delete;
+        RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+        // Drops every frame and takes the current machine as the only one, after loading a state for example
+        void reset(const CPU& cpu, Interconnect& interconnect);
+
+        // Once per emulated frame, on the emulation thread
+        void onFrame(const CPU& cpu, Interconnect& interconnect);
+
+        // Restores the newest snapshot and drops it, false when there is nothing left
+        bool rewind(CPU& cpu, Interconnect& interconnect);
+
+        size_t getFrameCount() const;
+        size_t getMemoryUsage() const;
+
+    private:
+        using PageId = std::pair<MemoryRegion, uint32_t>;
+
+        struct Capture
+        {
+            std::vector<uint8_t> registers;
+            std::vector<PageId> pages;
+            std::vector<uint8_t> pageData;
+        };
+
+        struct Frame
+        {
+            std::vector<uint8_t> registers;
+            std::vector<uint8_t> delta; // Per page : region, index, compressed XOR
+            size_t size() const { return registers.size() + delta.size(); }
+        };
+
+        void captureFrame(const CPU& cpu, Interconnect& interconnect, Capture& capture);
+        void run();
+        void compressFrame(const Capture& capture, Frame& frame);
+        void applyDelta(const Frame& frame);
+        void waitUntilIdle(std::unique_lock<std::mutex>& lock);
+        uint8_t* shadowPage(PageId page) { return m_shadow[static_cast<uint32_t>(page.first)].data() + page.second * DIRTY_PAGE_SIZE; }
+
+        RewindConfig m_config;
+        uint32_t m_framesSinceCapture;
+
+        // Emulation thread only
+        std::vector<PageId> m_stalePages; // Differ between the machine and the shadow since the last rewind
+
+        // Worker thread only, unless idle
+        std::array<std::vector<uint8_t>, MEMORY_REGIONS.size()> m_shadow;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_idle;
+        std::deque<Capture> m_pendingCaptures;
+        std::vector<Capture> m_freeCaptures;
+        std::deque<Frame> m_frames;
+        size_t m_memoryUsage;
+        bool m_isBusy;
+        bool m_isStopping;
+        std::thread m_worker;
+    };
+}
+#endif
@@ -23,7 +23,11 @@ namespace ePugStation
             SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
 
             m_window = SDL_CreateWindow("ePugStation", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 512, SDL_WINDOW_OPENGL);
-            m_glContext = SDL_GL_CreateContext(m_window);
+
+            // One context per thread, nothing shared : frames go from one to the other through memory.
+            // The emulation context is created last, so it is current for the GPU construction.
+            m_presentationContext = SDL_GL_CreateContext(m_window);
+            m_emulationContext = SDL_GL_CreateContext(m_window);
 
             gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
 
@@ -35,15 +39,23 @@ namespace ePugStation
 
         ~SDLContext()
         {
+            SDL_GL_DeleteContext(m_emulationContext);
+            SDL_GL_DeleteContext(m_presentationContext);
             SDL_DestroyWindow(m_window);
             SDL_Quit();
         }
 
         SDL_Window* getWindow() const { return m_window; }
 
+        // A context is current on one thread at a time, release it before another thread takes it
+        void makeEmulationContextCurrent() { SDL_GL_MakeCurrent(m_window, m_emulationContext); }
+        void makePresentationContextCurrent() { SDL_GL_MakeCurrent(m_window, m_presentationContext); }
+        void releaseContext() { SDL_GL_MakeCurrent(m_window, nullptr); }
+
     private:
         SDL_Window* m_window;
-        SDL_GLContext m_glContext;
+        SDL_GLContext m_presentationContext;
+        SDL_GLContext m_emulationContext;
     };
 }
 
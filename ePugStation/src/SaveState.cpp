@@ -0,0 +1,151 @@
+#include "SaveState.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "DirtyPages.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using namespace ePugStation;
+
+    void writeHeader(SaveStateWriter& writer, SaveStateKind kind)
+    {
+        writer.write(SAVE_STATE_MAGIC);
+        writer.write(SAVE_STATE_VERSION);
+        writer.write(kind);
+    }
+
+    // Per region : page count, then every dirty page index followed by its compressed content
+    void saveDirtyPages(SaveStateWriter& writer, const Interconnect& interconnect)
+    {
+        std::array<uint8_t, DIRTY_PAGE_SIZE> page;
+        std::vector<uint32_t> dirtyPages;
+        for (MemoryRegion region : MEMORY_REGIONS)
+        {
+            dirtyPages.clear();
+            interconnect.forEachDirtyPage(DirtyTracker::SaveState, region, [&](uint32_t index) { dirtyPages.push_back(index); });
+
+            writer.write(static_cast<uint32_t>(dirtyPages.size()));
+            for (uint32_t index : dirtyPages)
+            {
+                interconnect.readPage(region, index, page.data());
+                writer.write(index);
+                writer.writeCompressed(page.data(), page.size());
+            }
+        }
+    }
+
+    // Pages of a delta, decompressed before anything is written to the machine
+    struct DirtyPageSet
+    {
+        std::vector<std::pair<MemoryRegion, uint32_t>> pages;
+        std::vector<uint8_t> data;
+    };
+
+    DirtyPageSet readDirtyPages(SaveStateReader& reader, const Interconnect& interconnect)
+    {
+        DirtyPageSet set;
+        for (MemoryRegion region : MEMORY_REGIONS)
+        {
+            uint32_t pageCount = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < pageCount; ++i)
+            {
+                uint32_t index = reader.read<uint32_t>();
+                if (index >= interconnect.getPageCount(region))
+                {
+                    throw std::runtime_error("Invalid page : " + std::to_string(index));
+                }
+                set.data.resize(set.data.size() + DIRTY_PAGE_SIZE);
+                reader.readCompressed(set.data.data() + set.data.size() - DIRTY_PAGE_SIZE, DIRTY_PAGE_SIZE);
+                set.pages.emplace_back(region, index);
+            }
+        }
+        return set;
+    }
+
+    void writeDirtyPages(const DirtyPageSet& set, Interconnect& interconnect)
+    {
+        for (size_t i = 0; i < set.pages.size(); ++i)
+        {
+            interconnect.writePage(set.pages[i].first, set.pages[i].second, set.data.data() + i * DIRTY_PAGE_SIZE);
+        }
+        interconnect.commitPages();
+    }
+}
+
+namespace ePugStation
+{
+    void saveState(const CPU& cpu, Interconnect& interconnect, std::vector<uint8_t>& buffer)
+    {
+        buffer.clear();
+        SaveStateWriter writer(buffer);
+        writeHeader(writer, SaveStateKind::Full);
+        cpu.saveState(writer);
+        interconnect.saveState(writer);
+        interconnect.clearDirtyState(DirtyTracker::SaveState);
+    }
+
+    void saveDeltaState(const CPU& cpu, Interconnect& interconnect, std::vector<uint8_t>& buffer)
+    {
+        buffer.clear();
+        SaveStateWriter writer(buffer);
+        writeHeader(writer, SaveStateKind::Delta);
+        cpu.saveState(writer);
+        interconnect.saveRegisters(writer);
+        saveDirtyPages(writer, interconnect);
+        interconnect.clearDirtyState(DirtyTracker::SaveState);
+    }
+
+    void loadState(CPU& cpu, Interconnect& interconnect, const uint8_t* data, size_t size)
+    {
+        SaveStateReader reader(data, size);
+        if (reader.read<uint32_t>() != SAVE_STATE_MAGIC)
+        {
+            throw std::runtime_error("Not a save state");
+        }
+        uint32_t version = reader.read<uint32_t>();
+        if (version != SAVE_STATE_VERSION)
+        {
+            throw std::runtime_error("Unsupported save state version : " + std::to_string(version));
+        }
+
+        auto kind = reader.read<SaveStateKind>();
+        if (kind != SaveStateKind::Full && kind != SaveStateKind::Delta)
+        {
+            throw std::runtime_error("Unknown save state kind : " + std::to_string(static_cast<uint32_t>(kind)));
+        }
+
+        // Walks the whole state first, so a corrupt one throws before the machine changes
+        SaveStateReader check = reader;
+        check.view(savedSize([&cpu](SaveStateWriter& writer) { cpu.saveState(writer); }));
+        DirtyPageSet dirtyPages;
+        if (kind == SaveStateKind::Full)
+        {
+            interconnect.skipState(check);
+        }
+        else
+        {
+            interconnect.skipRegisters(check);
+            dirtyPages = readDirtyPages(check, interconnect);
+        }
+        if (!check.isAtEnd())
+        {
+            throw std::runtime_error("Save state has trailing data");
+        }
+
+        cpu.loadState(reader);
+        if (kind == SaveStateKind::Full)
+        {
+            interconnect.loadState(reader);
+        }
+        else
+        {
+            interconnect.loadRegisters(reader);
+            writeDirtyPages(dirtyPages, interconnect);
+        }
+        interconnect.clearDirtyState(DirtyTracker::SaveState);
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef E_PUG_STATION_SAVE_STATE
+#define E_PUG_STATION_SAVE_STATE
+
+#include "Compression.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace ePugStation
+{
+    class CPU;
+    class Interconnect;
+
+    // Layout : header, CPU (with Cop0 and GTE), Interconnect registers (DMA, IRQ, GPU), then memory.
+    // Full states store RAM, BIOS overlay and VRAM raw, deltas store dirty pages per MemoryRegion.
+    // Fields are written one by one in a fixed order, bump the version when the order changes.
+    constexpr uint32_t SAVE_STATE_MAGIC = 0x53535045; // "EPSS"
+    constexpr uint32_t SAVE_STATE_VERSION = 3;
+
+    enum class SaveStateKind : uint32_t
+    {
+        Full = 0,  // RAM and VRAM stored raw, restored with a single copy each
+        Delta = 1  // Only pages written since the previous snapshot, LZ4 compressed
+    };
+
+    class SaveStateWriter
+    {
+    public:
+        SaveStateWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {}
+
+        template<typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written");
+            writeBlock(&value, sizeof(T));
+        }
+
+        void writeBlock(const void* data, size_t size)
+        {
+            size_t offset = m_buffer.size();
+            m_buffer.resize(offset + size);
+            std::memcpy(m_buffer.data() + offset, data, size);
+        }
+
+        // Compressed size followed by the compressed data
+        void writeCompressed(const void* data, size_t size)
+        {
+            size_t offset = m_buffer.size();
+            m_buffer.resize(offset + sizeof(uint32_t) + compressBound(size));
+            uint32_t compressedSize = static_cast<uint32_t>(compress(data, size, m_buffer.data() + offset + sizeof(uint32_t), compressBound(size)));
+            std::memcpy(m_buffer.data() + offset, &compressedSize, sizeof(uint32_t));
+            m_buffer.resize(offset + sizeof(uint32_t) + compressedSize);
+        }
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+    };
+
+    class SaveStateReader
+    {
+    public:
+        SaveStateReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+
+        template<typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read");
+            T value;
+            readBlock(&value, sizeof(T));
+            return value;
+        }
+
+        // Copies straight into the destination, no intermediate buffer
+        void readBlock(void* destination, size_t size)
+        {
+            std::memcpy(destination, view(size), size);
+        }
+
+        // "size" is the uncompressed size, known by the caller
+        void readCompressed(void* destination, size_t size)
+        {
+            uint32_t compressedSize = read<uint32_t>();
+            decompress(view(compressedSize), compressedSize, destination, size);
+        }
+
+        // Points inside the snapshot, valid as long as the snapshot data
+        const uint8_t* view(size_t size)
+        {
+            if (size > m_size - m_offset)
+            {
+                throw std::runtime_error("Save state truncated at offset : " + std::to_string(m_offset));
+            }
+            const uint8_t* data = m_data + m_offset;
+            m_offset += size;
+            return data;
+        }
+
+        bool isAtEnd() const { return m_offset == m_size; }
+        size_t remaining() const { return m_size - m_offset; }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset;
+    };
+
+    // Bytes written by "save", for sections with a fixed layout
+    template<typename SAVE>
+    size_t savedSize(SAVE save)
+    {
+        std::vector<uint8_t> buffer;
+        SaveStateWriter writer(buffer);
+        save(writer);
+        return buffer.size();
+    }
+
+    // Snapshot of the whole machine. "buffer" is overwritten, its capacity is reused between saves.
+    // Every save or load is the base of the next delta.
+    void saveState(const CPU& cpu, Interconnect& interconnect, std::vector<uint8_t>& buffer);
+
+    // Changes since the previous snapshot saved or loaded, only valid on top of that snapshot
+    void saveDeltaState(const CPU& cpu, Interconnect& interconnect, std::vector<uint8_t>& buffer);
+
+    // Full snapshots replace the machine state, deltas are applied on top of it.
+    // The whole state is checked first, the machine is left untouched when it throws.
+    void loadState(CPU& cpu, Interconnect& interconnect, const uint8_t* data, size_t size);
+}
+#endif
@@ -2,6 +2,8 @@
 #ifndef E_PUG_STATION_TYPES
 #define E_PUG_STATION_TYPES
 
+#include <cstdint>
+
 namespace ePugStation
 {
    struct TexCoord
@@ -32,6 +34,61 @@ namespace ePugStation
          }texPage;
       };
    };
+
+   struct Position
+   {
+      Position() : value(0) {}
+      Position(uint32_t reg) : value(reg) {}
+      Position(uint16_t in_x, uint16_t in_y) : value(0) { bit.x = in_x; bit.y = in_y; }
+      Position(const Position& pos) : value(0) { bit.x = pos.bit.x; bit.y = pos.bit.y; }
+      uint32_t getValue() { return value; }
+      union {
+         unsigned value;
+         struct {
+            int16_t x : 16;
+            int16_t y : 16;
+         }bit;
+      };
+   };
+
+   struct Color
+   {
+      Color() : value(0) {}
+      Color(uint32_t reg) : value(reg) {}
+      Color(uint8_t in_r, uint8_t in_g, uint8_t in_b) : value(0) { bit.r = in_r; bit.g = in_g; bit.b = in_b; }
+      Color(const Color& color) : value(0) { bit.r = color.bit.r; bit.g = color.bit.g; bit.b = color.bit.b; }
+      uint32_t getValue() { bit.other = 0;  return value; }
+      union {
+         unsigned value;
+         struct {
+            uint8_t r : 8;
+            uint8_t g : 8;
+            uint8_t b : 8;
+            uint8_t other : 8;
+         }bit;
+      };
+   };
+
+   // TODO: Refactor this, works for now, or else values get shifted with Color...
+   struct CustomColor
+   {
+      CustomColor() : r(0), g(0), b(0) {};
+      CustomColor(Color color) : r(color.bit.r), g(color.bit.g), b(color.bit.b) {};
+
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+   };
+
+   struct CustomTexCoord
+   {
+      CustomTexCoord() : x(0), y(0) {};
+      CustomTexCoord(TexCoord texCoord) : x(texCoord.coord.xPos), y(texCoord.coord.yPos) {};
+      CustomTexCoord(uint8_t xPos, uint8_t yPos) : x(xPos), y(yPos) {};
+
+      uint8_t x;
+      uint8_t y;
+   };
 }
 
 #endif
\ No newline at end of file
@@ -1,75 +1,32 @@
 #ifndef E_PUG_STATION_VRAM
 #define E_PUG_STATION_VRAM
 
-#include "glad/glad.h"
+#include "DirtyPages.h"
+
 #include <cstdint>
+#include <cstring>
 #include <array>
 
 namespace ePugStation
 {
+   constexpr uint32_t VRAM_WIDTH = 1024;
+   constexpr uint32_t VRAM_HEIGHT = 512;
+   constexpr uint32_t VRAM_WIDTH_4_bit = VRAM_WIDTH * 4;
    constexpr int VRAM_SIZE_4_bit = 1024 * 512 * 4;
    constexpr int VRAM_SIZE_16_bit = 1024 * 512;
+
+   // 64x32 pixels tiles, one DIRTY_PAGE_SIZE each, tracked for delta save states
+   constexpr uint32_t VRAM_TILE_WIDTH = 64;
+   constexpr uint32_t VRAM_TILE_HEIGHT = 32;
+   constexpr uint32_t VRAM_TILES_PER_ROW = 1024 / VRAM_TILE_WIDTH;
+   constexpr uint32_t VRAM_TILE_COUNT = VRAM_TILES_PER_ROW * (512 / VRAM_TILE_HEIGHT);
+   static_assert(VRAM_TILE_WIDTH * VRAM_TILE_HEIGHT * sizeof(uint16_t) == DIRTY_PAGE_SIZE);
+
+    // Software VRAM, with a 4 bit view (one texel per nibble) for the renderers to sample.
+    // Nothing is uploaded from here, the GPU hands the 4 bit view to its renderer after writes.
     class VRAM
     {
     public:
-        VRAM()
-        {
-            uint32_t buffer_mode = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
-
-            // 16bit VRAM pixel buffer
-            //glGenBuffers(1, &m_pbo16);
-            //glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo16);
-
-            //glBufferStorage(GL_PIXEL_UNPACK_BUFFER, VRAM_SIZE_16_bit, nullptr, buffer_mode);
-            //glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-
-            //glGenTextures(1, &m_texture16);
-            //glBindTexture(GL_TEXTURE_2D, m_texture16);
-
-            //// Set the texture wrapping parameters.
-            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-            //// Set texture filtering parameters.
-            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            //// Allocate space on the GPU.
-            //glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, 1024, 512, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
-
-            //glBindTexture(GL_TEXTURE_2D, m_texture16);
-            //glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo16);
-
-            //m_data16Bit = (uint16_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, VRAM_SIZE_16_bit, buffer_mode);
-
-
-            // 4bit VRAM pixel buffer.
-            glGenBuffers(1, &m_pbo4);
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo4);
-
-            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, VRAM_SIZE_4_bit, nullptr, buffer_mode);
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-
-            glGenTextures(1, &m_texture4);
-            glBindTexture(GL_TEXTURE_2D, m_texture4);
-
-            // Set the texture wrapping parameters.
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-            // Set texture filtering parameters.
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            // Allocate space on the GPU.
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 1024 * 4, 512, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
-
-            glBindTexture(GL_TEXTURE_2D, m_texture4);
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo4);
-
-            m_data4Bit = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, VRAM_SIZE_4_bit, buffer_mode);
-        }
-
         uint16_t read(uint32_t x, uint32_t y)
         {
            int index = (y * 1024) + x;
@@ -85,6 +42,7 @@ namespace ePugStation
         void write(uint32_t x, uint32_t y, uint16_t data)
         {
             int index = (y * 1024) + x;
+            m_dirtyTiles.mark((y / VRAM_TILE_HEIGHT) * VRAM_TILES_PER_ROW + (x / VRAM_TILE_WIDTH));
 
             // Write 16 bit data
             m_data16Bit[index] = data;
@@ -96,24 +54,67 @@ namespace ePugStation
             m_data4Bit[index * 4 + 3] = (uint8_t)(data >> 12) & 0xf;
         }
 
-        // Call me after vram update...
-        void uploadToGPU()
+        const uint16_t* data() const { return m_data16Bit; }
+        const uint8_t* data4Bit() const { return m_data4Bit; }
+
+        // Replaces the whole VRAM, 4 bit view included
+        void restore(const void* data)
+        {
+            std::memcpy(m_data16Bit, data, sizeof(m_data16Bit));
+            m_dirtyTiles.markAll();
+            for (int index = 0; index < VRAM_SIZE_16_bit; ++index)
+            {
+                uint16_t pixel = m_data16Bit[index];
+                m_data4Bit[index * 4 + 0] = pixel & 0xf;
+                m_data4Bit[index * 4 + 1] = (pixel >> 4) & 0xf;
+                m_data4Bit[index * 4 + 2] = (pixel >> 8) & 0xf;
+                m_data4Bit[index * 4 + 3] = (pixel >> 12) & 0xf;
+            }
+        }
+
+        const DirtyPages<VRAM_TILE_COUNT>& getDirtyTiles() const { return m_dirtyTiles; }
+
+        // Tiles are packed row by row into DIRTY_PAGE_SIZE bytes
+        void readTile(uint32_t tileIndex, uint8_t* data) const
+        {
+            const uint16_t* topLeft = tileTopLeft(tileIndex);
+            for (uint32_t row = 0; row < VRAM_TILE_HEIGHT; ++row)
+            {
+                std::memcpy(data + row * VRAM_TILE_WIDTH * sizeof(uint16_t), topLeft + row * 1024, VRAM_TILE_WIDTH * sizeof(uint16_t));
+            }
+        }
+
+        // Not uploaded, the GPU uploads once a batch of tiles is written
+        void writeTile(uint32_t tileIndex, const uint8_t* data)
         {
-            glBindTexture(GL_TEXTURE_2D, m_texture4);
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo4);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 4096, 512, GL_RED, GL_UNSIGNED_BYTE, 0);
+            uint32_t startX = (tileIndex % VRAM_TILES_PER_ROW) * VRAM_TILE_WIDTH;
+            uint32_t startY = (tileIndex / VRAM_TILES_PER_ROW) * VRAM_TILE_HEIGHT;
+            for (uint32_t y = 0; y < VRAM_TILE_HEIGHT; ++y)
+            {
+                for (uint32_t x = 0; x < VRAM_TILE_WIDTH; ++x)
+                {
+                    uint16_t pixel;
+                    std::memcpy(&pixel, data + (y * VRAM_TILE_WIDTH + x) * sizeof(uint16_t), sizeof(uint16_t));
+                    write(startX + x, startY + y, pixel);
+                }
+            }
         }
 
+        void clearDirtyTiles(DirtyTracker tracker) { m_dirtyTiles.clear(tracker); }
+
     private:
-       // 16 bit related
-       uint32_t m_pbo16;
-       uint32_t m_texture16;
-       uint16_t m_data16Bit[VRAM_SIZE_16_bit];
-
-        // 4 bit related
-        uint32_t m_pbo4;
-        uint32_t m_texture4;
-        uint8_t* m_data4Bit;
+       const uint16_t* tileTopLeft(uint32_t tileIndex) const
+       {
+          uint32_t x = (tileIndex % VRAM_TILES_PER_ROW) * VRAM_TILE_WIDTH;
+          uint32_t y = (tileIndex / VRAM_TILES_PER_ROW) * VRAM_TILE_HEIGHT;
+          return m_data16Bit + y * 1024 + x;
+       }
+
+       DirtyPages<VRAM_TILE_COUNT> m_dirtyTiles;
+
+       // Zeroed, so instances start from identical VRAM
+       uint16_t m_data16Bit[VRAM_SIZE_16_bit] = {};
+       uint8_t m_data4Bit[VRAM_SIZE_4_bit] = {};
     };
 }
 
@@ -1,42 +1,463 @@
 #include "SDLContext.h"
+#include "BiosImage.h"
 #include "Interconnect.h"
 #include "CPU.h"
+#include "CodeCache.h"
+#include "Emulator.h"
+#include "FrameHash.h"
+#include "FramePacer.h"
+#include "GLRenderer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Presenter.h"
+#include "PsxExecutable.h"
+#include "Replay.h"
+#include "RewindBuffer.h"
+#include "Timeline.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
 
 #include "SDL2/SDL.h"
 
-int main(int /*argc*/, char** /*argv[]*/)
+namespace
+{
+   constexpr uint32_t METRICS_SAVE_INTERVAL = 60; // Frames
+
+   // Keyboard layout of the digital pad
+   uint16_t padButtonFromKey(SDL_Keycode key)
+   {
+      switch (key)
+      {
+      case SDLK_UP: return ePugStation::PAD_UP;
+      case SDLK_DOWN: return ePugStation::PAD_DOWN;
+      case SDLK_LEFT: return ePugStation::PAD_LEFT;
+      case SDLK_RIGHT: return ePugStation::PAD_RIGHT;
+      case SDLK_x: return ePugStation::PAD_CROSS;
+      case SDLK_c: return ePugStation::PAD_CIRCLE;
+      case SDLK_z: return ePugStation::PAD_SQUARE;
+      case SDLK_s: return ePugStation::PAD_TRIANGLE;
+      case SDLK_q: return ePugStation::PAD_L1;
+      case SDLK_w: return ePugStation::PAD_R1;
+      case SDLK_a: return ePugStation::PAD_L2;
+      case SDLK_e: return ePugStation::PAD_R2;
+      case SDLK_RETURN: return ePugStation::PAD_START;
+      case SDLK_RSHIFT: return ePugStation::PAD_SELECT;
+      default: return 0;
+      }
+   }
+
+   // Report at "path", folded stacks next to it for flamegraph.pl
+   void saveProfile(const ePugStation::Profiler& profiler, const std::string& path)
+   {
+      std::ofstream report(path);
+      profiler.writeReport(report);
+      std::ofstream foldedStacks(path + ".folded");
+      profiler.writeFoldedStacks(foldedStacks);
+   }
+
+   void saveMetrics(const std::string& path, bool hasSummary)
+   {
+      if (!path.empty())
+      {
+         ePugStation::saveMetricsPrometheus(path);
+      }
+      if (hasSummary)
+      {
+         ePugStation::getMetrics().writeText(std::cout);
+      }
+   }
+
+   // No event polling and no throttling, prints the hashes of every frame
+   int replay(const std::string& path, ePugStation::CPU& cpu, ePugStation::Interconnect& interconnect,
+              ePugStation::FrameHashLogWriter* hashLog, ePugStation::TraceRecorder* trace, ePugStation::Profiler* profiler)
+   {
+      auto replay = ePugStation::Replay::load(path);
+      auto result = ePugStation::runReplay(replay, cpu, interconnect, [&](uint32_t frame, const ePugStation::FrameHashes& hashes)
+      {
+         std::printf("%u %08x %08x %08x\n", frame, hashes.ram, hashes.vram, hashes.display);
+         if (hashLog)
+         {
+            hashLog->append(hashes);
+         }
+      }, trace, profiler);
+
+      if (result.firstMismatch)
+      {
+         std::cout << "Replay diverges at frame " << *result.firstMismatch << "\n";
+         return 1;
+      }
+      std::cout << "Replay matches over " << result.frameCount << " frames\n";
+      return 0;
+   }
+}
+
+// ePugStation [--bios <file>] [--code-cache <dir>] [--exe <file> [--skip-bios]] [--record <replay>] [--replay <replay>] [--hash-log <log>] [--trace <trace>] [--profile <report>] [--profile-timer <us>] [--timeline <json>] [--metrics <file>] [--metrics-summary] [--log-summary] [--rewind] [--turbo]
+int main(int argc, char** argv)
 {
-   ePugStation::SDLContext sdlContext;
-   auto interconnect = new ePugStation::Interconnect(&sdlContext);
-   auto cpu = ePugStation::CPU(interconnect);
+   std::string biosPath = ePugStation::PATH_TO_BIOS;
+   std::string exePath;
+   bool isSkippingBios = false;
+   std::string recordPath;
+   std::string replayPath;
+   std::string hashLogPath;
+   std::string tracePath;
+   std::string profilePath;
+   ePugStation::ProfilerConfig profilerConfig;
+   std::string timelinePath;
+   std::string metricsPath;
+   bool hasMetricsSummary = false;
+   bool hasLogSummary = false;
+   bool hasRewind = false;
+   bool isTurbo = false;
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string argument = argv[i];
+      if (argument == "--bios" && i + 1 < argc)
+      {
+         biosPath = argv[++i];
+      }
+      else if (argument == "--code-cache" && i + 1 < argc)
+      {
+         ePugStation::setCodeCacheDirectory(argv[++i]);
+      }
+      else if (argument == "--exe" && i + 1 < argc)
+      {
+         exePath = argv[++i];
+      }
+      else if (argument == "--skip-bios")
+      {
+         isSkippingBios = true;
+      }
+      else if (argument == "--record" && i + 1 < argc)
+      {
+         recordPath = argv[++i];
+      }
+      else if (argument == "--replay" && i + 1 < argc)
+      {
+         replayPath = argv[++i];
+      }
+      else if (argument == "--hash-log" && i + 1 < argc)
+      {
+         hashLogPath = argv[++i];
+      }
+      else if (argument == "--trace" && i + 1 < argc)
+      {
+         tracePath = argv[++i];
+      }
+      else if (argument == "--profile" && i + 1 < argc)
+      {
+         profilePath = argv[++i];
+      }
+      else if (argument == "--profile-timer" && i + 1 < argc)
+      {
+         profilerConfig.timerInterval = static_cast<uint32_t>(std::stoul(argv[++i]));
+      }
+      else if (argument == "--timeline" && i + 1 < argc)
+      {
+         timelinePath = argv[++i];
+         ePugStation::setTimelineEnabled(true);
+      }
+      else if (argument == "--metrics" && i + 1 < argc)
+      {
+         metricsPath = argv[++i];
+      }
+      else if (argument == "--metrics-summary")
+      {
+         hasMetricsSummary = true;
+      }
+      else if (argument == "--log-summary")
+      {
+         hasLogSummary = true;
+      }
+      else if (argument == "--rewind")
+      {
+         hasRewind = true;
+      }
+      else if (argument == "--turbo")
+      {
+         isTurbo = true;
+      }
+      else
+      {
+         std::cout << "Unknown argument " << argument << "\n";
+         return -1;
+      }
+   }
+
+   if (hasRewind && !recordPath.empty())
+   {
+      // A rewound recording would no longer match its inputs
+      std::cout << "--rewind and --record cannot be combined\n";
+      return -1;
+   }
+   if (!exePath.empty() && !isSkippingBios && !recordPath.empty())
+   {
+      // Recordings start from a snapshot and never go through the boot hand over
+      std::cout << "--record with --exe needs --skip-bios\n";
+      return -1;
+   }
+
+   // Replays run headless, frame hashes only need the GPU's own VRAM
+   std::unique_ptr<ePugStation::SDLContext> sdlContext;
+   std::unique_ptr<ePugStation::GPU> emulatedGpu;
+   if (replayPath.empty())
+   {
+      sdlContext = std::make_unique<ePugStation::SDLContext>();
+      emulatedGpu = std::make_unique<ePugStation::GPU>(std::make_unique<ePugStation::GLRenderer>());
+   }
+   else
+   {
+      emulatedGpu = std::make_unique<ePugStation::GPU>();
+   }
+   ePugStation::Emulator emulator(ePugStation::BiosImage::fromFile(biosPath), std::move(emulatedGpu));
+   if (!exePath.empty())
+   {
+      // Straight to the entry point, or once the BIOS kernel is initialized
+      auto executable = ePugStation::PsxExecutable::fromFile(exePath);
+      if (isSkippingBios)
+      {
+         emulator.loadExecutable(*executable);
+      }
+      else
+      {
+         emulator.loadExecutableAfterBoot(executable);
+      }
+   }
+   ePugStation::CPU& cpu = emulator.getCPU();
+   ePugStation::Interconnect& interconnect = emulator.getInterconnect();
+   ePugStation::GPU* gpu = interconnect.getGPU();
+
+   std::unique_ptr<ePugStation::FrameHashLogWriter> hashLog;
+   if (!hashLogPath.empty())
+   {
+      hashLog = std::make_unique<ePugStation::FrameHashLogWriter>(hashLogPath);
+   }
+
+   // Keeps the last instructions only, saved on exit
+   std::unique_ptr<ePugStation::TraceRecorder> trace;
+   if (!tracePath.empty())
+   {
+      trace = std::make_unique<ePugStation::TraceRecorder>();
+   }
+
+   std::unique_ptr<ePugStation::Profiler> profiler;
+   if (!profilePath.empty())
+   {
+      profiler = std::make_unique<ePugStation::Profiler>(profilerConfig);
+   }
+
+   if (!replayPath.empty())
+   {
+      int result = replay(replayPath, cpu, interconnect, hashLog.get(), trace.get(), profiler.get());
+      if (trace)
+      {
+         trace->save(tracePath);
+      }
+      if (profiler)
+      {
+         saveProfile(*profiler, profilePath);
+      }
+      saveMetrics(metricsPath, hasMetricsSummary);
+      if (!timelinePath.empty())
+      {
+         ePugStation::saveTimeline(timelinePath);
+      }
+      if (hasLogSummary)
+      {
+         ePugStation::printLogSummary();
+      }
+      return result;
+   }
 
-   bool isRunning = true;
-   while (isRunning)
+   std::unique_ptr<ePugStation::ReplayRecorder> recorder;
+   if (!recordPath.empty())
    {
-      for (int i = 0; i < 100000; ++i)
+      // Replays have a fixed frame length, the one of the video mode when recording starts
+      recorder = std::make_unique<ePugStation::ReplayRecorder>(cpu, interconnect, emulator.getInstructionsPerFrame());
+   }
+
+   // Snapshot every frame, walked back while the rewind key is held
+   std::unique_ptr<ePugStation::RewindBuffer> rewindBuffer;
+   if (hasRewind)
+   {
+      rewindBuffer = std::make_unique<ePugStation::RewindBuffer>(cpu, interconnect);
+   }
+
+   // Set by the presentation thread, read once per frame by the emulation thread
+   std::atomic<uint16_t> padButtons{ 0 };
+   std::atomic<bool> isRewinding{ false };
+   std::atomic<bool> isThrottled{ !isTurbo };
+   std::atomic<bool> isRunning{ true };
+   ePugStation::TripleBuffer<ePugStation::DisplayFrame> frames;
+   std::exception_ptr emulationError;
+
+   // Emulates and renders with its own GL context, never waits on the window
+   sdlContext->releaseContext();
+   std::thread emulation([&]
+   {
+      try
+      {
+         sdlContext->makeEmulationContextCurrent();
+         ePugStation::FramePacer pacer(ePugStation::getRefreshRate(gpu->getVideoMode()));
+         ePugStation::FrameInput input;
+         uint64_t frame = 0;
+         while (isRunning.load(std::memory_order_relaxed))
+         {
+            E_PUG_STATION_TIMER("Frame");
+            ePugStation::VideoMode videoMode = gpu->getVideoMode();
+            input.padButtons = padButtons.load(std::memory_order_relaxed);
+            if (rewindBuffer && isRewinding.load(std::memory_order_relaxed))
+            {
+               // Stays on the oldest frame once the buffer is empty
+               rewindBuffer->rewind(cpu, interconnect);
+            }
+            else if (recorder)
+            {
+               recorder->runFrame(cpu, interconnect, input, trace.get(), profiler.get());
+            }
+            else
+            {
+               emulator.runFrame(input, trace.get(), profiler.get());
+               if (rewindBuffer)
+               {
+                  rewindBuffer->onFrame(cpu, interconnect);
+               }
+            }
+            if (hashLog)
+            {
+               hashLog->append(emulator.hashFrame());
+            }
+            ++frame;
+            if (!metricsPath.empty() && frame % METRICS_SAVE_INTERVAL == 0)
+            {
+               ePugStation::saveMetricsPrometheus(metricsPath);
+            }
+
+            ePugStation::DisplayFrame& displayFrame = frames.getWriteBuffer();
+            gpu->captureFrame(displayFrame);
+            displayFrame.number = frame;
+            displayFrame.speed = pacer.getSpeed();
+            displayFrame.frameRate = pacer.getFrameRate();
+            displayFrame.isThrottled = pacer.isThrottled();
+            frames.publish();
+
+            pacer.setThrottled(isThrottled.load(std::memory_order_relaxed));
+            pacer.setRefreshRate(ePugStation::getRefreshRate(videoMode));
+            pacer.endFrame();
+         }
+      }
+      catch (...)
       {
-         cpu.runNextInstruction();
+         emulationError = std::current_exception();
+         isRunning.store(false, std::memory_order_relaxed);
       }
+      sdlContext->releaseContext();
+   });
 
-      SDL_Event sdlEvent;
-      if (SDL_PollEvent(&sdlEvent) != SDL_SUCCESS)
+   // Presentation and input, vsync stalls stay on this thread
+   {
+      ePugStation::Presenter presenter(sdlContext.get());
+      uint16_t buttons = 0;
+      double shownSpeed = -1.0;
+      while (isRunning.load(std::memory_order_relaxed))
       {
-         switch (sdlEvent.type)
          {
-         case SDL_QUIT:
-            isRunning = false;
-            break;
-         case SDL_KEYDOWN:
-            if (sdlEvent.key.keysym.sym == SDLK_ESCAPE)
+            E_PUG_STATION_TIMER("Events");
+            SDL_Event sdlEvent;
+            while (SDL_PollEvent(&sdlEvent) != SDL_SUCCESS)
             {
-               isRunning = false;
+               switch (sdlEvent.type)
+               {
+               case SDL_QUIT:
+                  isRunning.store(false, std::memory_order_relaxed);
+                  break;
+               case SDL_KEYDOWN:
+                  if (sdlEvent.key.keysym.sym == SDLK_ESCAPE)
+                  {
+                     isRunning.store(false, std::memory_order_relaxed);
+                  }
+                  else if (sdlEvent.key.keysym.sym == SDLK_TAB)
+                  {
+                     isThrottled.store(!isThrottled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                  }
+                  else if (sdlEvent.key.keysym.sym == SDLK_BACKSPACE)
+                  {
+                     isRewinding.store(true, std::memory_order_relaxed);
+                  }
+                  buttons |= padButtonFromKey(sdlEvent.key.keysym.sym);
+                  break;
+               case SDL_KEYUP:
+                  if (sdlEvent.key.keysym.sym == SDLK_BACKSPACE)
+                  {
+                     isRewinding.store(false, std::memory_order_relaxed);
+                  }
+                  buttons &= ~padButtonFromKey(sdlEvent.key.keysym.sym);
+                  break;
+               default:
+                  E_PUG_STATION_LOG(Debug, Frontend, "Unhandled event 0x%x", sdlEvent.type);
+               }
             }
-            break;
-         default:
-            std::cout << "Unhandled event\n";
+            padButtons.store(buttons, std::memory_order_relaxed);
+         }
+
+         if (!frames.update())
+         {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+         }
+
+         const ePugStation::DisplayFrame& frame = frames.getReadBuffer();
+         presenter.present(frame);
+         if (frame.speed != shownSpeed)
+         {
+            shownSpeed = frame.speed;
+            char title[64];
+            std::snprintf(title, sizeof(title), "ePugStation - %.2fx, %.1f fps%s", frame.speed, frame.frameRate,
+                          frame.isThrottled ? "" : " (turbo)");
+            SDL_SetWindowTitle(sdlContext->getWindow(), title);
          }
       }
    }
+   emulation.join();
+   if (emulationError)
+   {
+      std::rethrow_exception(emulationError);
+   }
+
+   // The GPU goes with the rest of the machine, in the context owning its objects
+   sdlContext->makeEmulationContextCurrent();
+
+   if (recorder)
+   {
+      recorder->getReplay().save(recordPath);
+   }
+   if (trace)
+   {
+      trace->save(tracePath);
+   }
+   if (profiler)
+   {
+      saveProfile(*profiler, profilePath);
+   }
+   saveMetrics(metricsPath, hasMetricsSummary);
+   if (!timelinePath.empty())
+   {
+      ePugStation::saveTimeline(timelinePath);
+   }
+   if (hasLogSummary)
+   {
+      ePugStation::printLogSummary();
+   }
 
    return -1;
 }
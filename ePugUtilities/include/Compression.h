@@ -0,0 +1,20 @@
+#ifndef E_PUG_STATION_COMPRESSION
+#define E_PUG_STATION_COMPRESSION
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ePugStation
+{
+    // LZ4 block compression, fast enough to run on every emulated frame
+
+    // Worst case compressed size of "size" bytes
+    size_t compressBound(size_t size);
+
+    // Returns the compressed size, "capacity" must be at least compressBound(size)
+    size_t compress(const void* data, size_t size, void* output, size_t capacity);
+
+    // Throws unless exactly "size" bytes are decoded
+    void decompress(const void* data, size_t compressedSize, void* output, size_t size);
+}
+#endif
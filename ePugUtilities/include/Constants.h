@@ -11,7 +11,7 @@ namespace ePugStation
     constexpr uint32_t BIOS_ROM_LOGICAL = 0xbfc00000;
     constexpr uint32_t BIOS_ROM_PHYSICAL = 0x1fc00000;
     constexpr const char* PATH_TO_BIOS = "..\\data\\SCPH1001.BIN";
-    constexpr size_t BIOS_MEMORY_SIZE = 514 * 1024;
+    constexpr size_t BIOS_MEMORY_SIZE = 512 * 1024;
     constexpr Range<BIOS_ROM_PHYSICAL, BIOS_MEMORY_SIZE> BIOS_RANGE_PHYSICAL;
 
     // Mem control
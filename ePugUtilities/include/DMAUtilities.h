@@ -0,0 +1,13 @@
+#ifndef E_PUG_STATION_DMA_UTILITIES
+#define E_PUG_STATION_DMA_UTILITIES
+
+#include <cstdint>
+
+namespace ePugStation
+{
+    // DMA channel 6 : builds the ordering table as a reverse linked list, starting
+    // at "address" and going backward. Each entry points to the previous word and
+    // the last one holds the 0xffffff end marker. RAM address wraps like the DMA does.
+    void clearOrderingTable(uint32_t* ram, uint32_t address, uint32_t entries);
+}
+#endif
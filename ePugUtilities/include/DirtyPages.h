@@ -0,0 +1,119 @@
+#ifndef E_PUG_STATION_DIRTY_PAGES
+#define E_PUG_STATION_DIRTY_PAGES
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ePugStation
+{
+    constexpr uint32_t DIRTY_PAGE_SHIFT = 12;
+    constexpr uint32_t DIRTY_PAGE_SIZE = 1 << DIRTY_PAGE_SHIFT; // 4 KiB
+
+    // Consumers of the dirty pages, each one clears its own set without hiding writes from the others
+    enum class DirtyTracker : uint32_t
+    {
+        SaveState = 0, // Delta save states, cleared by every save or load
+        Rewind,        // Rewind buffer captures
+        Count
+    };
+
+    constexpr size_t DIRTY_TRACKER_COUNT = static_cast<size_t>(DirtyTracker::Count);
+
+    // One bit per page and tracker, set on every write and cleared per tracker
+    template<uint32_t PAGE_COUNT>
+    class DirtyPages
+    {
+    public:
+        DirtyPages() { clear(); }
+
+        void mark(uint32_t page)
+        {
+            for (auto& bits : m_bits)
+            {
+                bits[page >> 6] |= uint64_t(1) << (page & 63);
+            }
+        }
+
+        bool isDirty(DirtyTracker tracker, uint32_t page) const
+        {
+            return (m_bits[static_cast<size_t>(tracker)][page >> 6] >> (page & 63)) & 1;
+        }
+
+        // Pages "first" to "last" included
+        void markRange(uint32_t first, uint32_t last)
+        {
+            for (uint32_t page = first; page <= last; ++page)
+            {
+                mark(page);
+            }
+        }
+
+        void markAll()
+        {
+            for (auto& bits : m_bits)
+            {
+                bits.fill(~uint64_t(0));
+            }
+        }
+
+        void clear()
+        {
+            for (auto& bits : m_bits)
+            {
+                bits.fill(0);
+            }
+        }
+
+        void clear(DirtyTracker tracker) { m_bits[static_cast<size_t>(tracker)].fill(0); }
+
+        uint32_t count(DirtyTracker tracker) const
+        {
+            uint32_t total = 0;
+            forEach(tracker, [&total](uint32_t) { ++total; });
+            return total;
+        }
+
+        // Calls "function(page)" for every page dirty for "tracker", in increasing order
+        template<typename FUNCTION>
+        void forEach(DirtyTracker tracker, FUNCTION&& function) const
+        {
+            const auto& trackerBits = m_bits[static_cast<size_t>(tracker)];
+            for (uint32_t word = 0; word < WORD_COUNT; ++word)
+            {
+                uint64_t bits = trackerBits[word];
+                while (bits != 0)
+                {
+                    uint32_t page = (word << 6) + countTrailingZeros(bits);
+                    if (page >= PAGE_COUNT)
+                    {
+                        return;
+                    }
+                    function(page);
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t WORD_COUNT = (PAGE_COUNT + 63) / 64;
+
+        static uint32_t countTrailingZeros(uint64_t bits)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, bits);
+            return index;
+#else
+            return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+        }
+
+        std::array<std::array<uint64_t, WORD_COUNT>, DIRTY_TRACKER_COUNT> m_bits;
+    };
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef E_PUG_STATION_FRAME_PACER
+#define E_PUG_STATION_FRAME_PACER
+
+#include <chrono>
+#include <cstdint>
+
+namespace ePugStation
+{
+    // Holds frames to the emulated refresh rate, or lets them run as fast as possible, and measures
+    // the achieved speed against real time either way
+    class FramePacer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit FramePacer(double refreshRate, Clock::duration measureInterval = std::chrono::seconds(1));
+
+        // Follows video mode changes, the next deadline is one new period away
+        void setRefreshRate(double refreshRate);
+
+        void setThrottled(bool isThrottled);
+        bool isThrottled() const { return m_isThrottled; }
+
+        // Sleeps until the frame deadline when throttled. True when a new speed measurement is available.
+        bool endFrame();
+
+        // Emulated time over host time during the last measurement, 1.0 is real time
+        double getSpeed() const { return m_speed; }
+        double getFrameRate() const { return m_frameRate; }
+
+    private:
+        Clock::duration m_framePeriod;
+        Clock::duration m_measureInterval;
+        Clock::time_point m_deadline;
+        bool m_isThrottled = true;
+
+        Clock::time_point m_measureStart;
+        uint32_t m_measuredFrames = 0;
+        Clock::duration m_emulatedTime = Clock::duration::zero();
+        double m_speed = 0.0;
+        double m_frameRate = 0.0;
+    };
+}
+#endif
@@ -0,0 +1,15 @@
+#ifndef E_PUG_STATION_HASH
+#define E_PUG_STATION_HASH
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ePugStation
+{
+    // XXH64, stable across platforms and builds, so digests can be compared between runs
+    uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+    // CRC32C (Castagnoli), SSE4.2 instruction when the host has it. Chains : crc32c(b, crc32c(a)) is the CRC of a then b.
+    uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+}
+#endif
@@ -2,6 +2,7 @@
 #define E_PUG_STATION_INSTRUCTION
 
 #include <cstdint>
+#include <cstddef>
 
 namespace ePugStation
 {
@@ -166,5 +167,41 @@ namespace ePugStation
             }op;
         };
     };
+    // Every instruction the CPU executes, primary, SPECIAL and REGIMM ops flattened so one lookup
+    // dispatches any instruction. Coprocessor sub ops are left to their coprocessor.
+    enum class Opcode : uint8_t
+    {
+        // Primary
+        J, JAL, BEQ, BNE, BLEZ, BGTZ,
+        ADDI, ADDIU, SLTI, SLTIU, ANDI, ORI, XORI, LUI,
+        Cop0, Cop1, Cop2, Cop3,
+        LB, LBU, LH, LWL, LW, LHU, LWR,
+        SB, SH, SWL, SW, SWR,
+        LWC0, LWC1, LWC2, LWC3,
+        SWC0, SWC1, SWC2, SWC3,
+
+        // SPECIAL (SubOp)
+        SLL, SRL, SRA, SLLV, SRLV, SRAV,
+        JR, JALR, SYSCALL, BREAK,
+        MFHI, MTHI, MFLO, MTLO,
+        MULT, MULTU, DIV, DIVU,
+        ADD, ADDU, SUB, SUBU,
+        AND, OR, XOR, NOR, SLT, SLTU,
+
+        // REGIMM (BranchOp)
+        BLTZ, BGEZ, BLTZAL, BGEZAL,
+
+        // Undefined encodings, executing them throws
+        InvalidPrimary, InvalidSubOp, InvalidBranchOp,
+
+        Count
+    };
+
+    constexpr size_t OPCODE_COUNT = static_cast<size_t>(Opcode::Count);
+    // Bump whenever the Opcode values or decodeOpcode() change, saved code caches are then ignored
+    constexpr uint32_t OPCODE_TABLE_VERSION = 1;
+
+    // Depends on the word only, so decoded code can be cached and shared
+    Opcode decodeOpcode(uint32_t word);
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,108 @@
+#ifndef E_PUG_STATION_LOGGER
+#define E_PUG_STATION_LOGGER
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace ePugStation
+{
+    enum class LogLevel : uint8_t
+    {
+        Trace = 0,
+        Debug = 1,
+        Info = 2,
+        Warning = 3,
+        Error = 4,
+        Off = 5
+    };
+
+    enum class LogSubsystem : uint8_t
+    {
+        CPU = 0,
+        Memory,   // Interconnect, unhandled devices
+        DMA,
+        GPU,
+        Renderer,
+        SaveState,
+        Frontend,
+        Count
+    };
+
+    // Messages below this level are compiled out, override with -DE_PUG_STATION_MIN_LOG_LEVEL=<0-5>
+#ifndef E_PUG_STATION_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define E_PUG_STATION_MIN_LOG_LEVEL 2
+#else
+#define E_PUG_STATION_MIN_LOG_LEVEL 0
+#endif
+#endif
+    constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(E_PUG_STATION_MIN_LOG_LEVEL);
+
+    // First messages of a call site always go through, then one per second with the count of the dropped ones
+    constexpr uint32_t LOG_BURST = 5;
+
+    // One per call site, counts every hit even when the message is dropped
+    class LogSite
+    {
+    public:
+        LogSite(LogLevel level, LogSubsystem subsystem, const char* file, int line);
+
+        bool shouldLog();
+        // Hits dropped since the last message, reset by the call
+        uint64_t takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+        LogLevel getLevel() const { return m_level; }
+        LogSubsystem getSubsystem() const { return m_subsystem; }
+        const char* getFile() const { return m_file; }
+        int getLine() const { return m_line; }
+        uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        const LogSite* getNext() const { return m_next; }
+
+    private:
+        LogLevel m_level;
+        LogSubsystem m_subsystem;
+        const char* m_file;
+        int m_line;
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_suppressed;
+        std::atomic<int64_t> m_lastMessageTime;
+        LogSite* m_next; // Every site, for the summary
+    };
+
+    // Runtime level per subsystem, Info by default
+    void setLogLevel(LogSubsystem subsystem, LogLevel level);
+    LogLevel getLogLevel(LogSubsystem subsystem);
+
+    // Called on the logging thread only. Default prints to stdout.
+    using LogSink = std::function<void(LogLevel level, LogSubsystem subsystem, const char* message)>;
+    void setLogSink(LogSink sink);
+
+    // Formats into the lock-free queue, the message is dropped (and counted) when the queue is full
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    void log(LogSite& site, const char* format, ...);
+
+    // Waits until every message queued so far reached the sink
+    void flushLog();
+
+    // Hits per call site, suppressed ones included, most frequent first
+    void printLogSummary();
+}
+
+#define E_PUG_STATION_LOG(LEVEL, SUBSYSTEM, ...)                                                             \
+    do                                                                                                      \
+    {                                                                                                       \
+        if constexpr (::ePugStation::LogLevel::LEVEL >= ::ePugStation::MIN_LOG_LEVEL)                       \
+        {                                                                                                   \
+            static ::ePugStation::LogSite logSite(::ePugStation::LogLevel::LEVEL,                           \
+                                                  ::ePugStation::LogSubsystem::SUBSYSTEM, __FILE__, __LINE__); \
+            if (logSite.shouldLog())                                                                        \
+            {                                                                                               \
+                ::ePugStation::log(logSite, __VA_ARGS__);                                                   \
+            }                                                                                               \
+        }                                                                                                   \
+    } while (false)
+
+#endif
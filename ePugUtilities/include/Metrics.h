@@ -0,0 +1,98 @@
+#ifndef E_PUG_STATION_METRICS
+#define E_PUG_STATION_METRICS
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace ePugStation
+{
+    enum class Metric : uint32_t
+    {
+        Instructions = 0,
+        RamAccesses,
+        BiosAccesses,
+        MmioAccesses,
+        Exceptions,
+        Vertices,
+        DrawCalls,
+        VramUploadBytes,
+        Count
+    };
+
+    constexpr size_t METRIC_DMA_CHANNELS = 7;
+    constexpr size_t METRIC_GP0_OPCODES = 256;
+
+    // Scalar metrics, then DMA words per channel, then GP0 commands per opcode
+    constexpr size_t METRIC_DMA_WORDS_SLOT = static_cast<size_t>(Metric::Count);
+    constexpr size_t METRIC_GP0_COMMANDS_SLOT = METRIC_DMA_WORDS_SLOT + METRIC_DMA_CHANNELS;
+    constexpr size_t METRIC_SLOT_COUNT = METRIC_GP0_COMMANDS_SLOT + METRIC_GP0_OPCODES;
+
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Written by its thread only, so a relaxed load and store replaces the locked add. Aligned on a
+    // cache line so threads counting at the same time never share one.
+    struct alignas(CACHE_LINE_SIZE) MetricBlock
+    {
+        std::array<std::atomic<uint64_t>, METRIC_SLOT_COUNT> values{};
+    };
+
+    // Registers the calling thread, its counts are kept once it exits
+    MetricBlock* registerMetricThread();
+
+    inline thread_local MetricBlock* t_metricBlock = nullptr;
+
+    inline void addMetricSlot(size_t slot, uint64_t value)
+    {
+        MetricBlock* block = t_metricBlock;
+        if (!block)
+        {
+            block = registerMetricThread();
+        }
+        std::atomic<uint64_t>& counter = block->values[slot];
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    inline void countMetric(Metric metric, uint64_t value = 1)
+    {
+        addMetricSlot(static_cast<size_t>(metric), value);
+    }
+
+    inline void countDmaWords(uint32_t channel, uint64_t words)
+    {
+        addMetricSlot(METRIC_DMA_WORDS_SLOT + channel, words);
+    }
+
+    inline void countGp0Command(uint8_t opcode)
+    {
+        addMetricSlot(METRIC_GP0_COMMANDS_SLOT + opcode, 1);
+    }
+
+    // Sum over every thread, running or exited, at the time of the call
+    class MetricsSnapshot
+    {
+    public:
+        uint64_t get(Metric metric) const { return m_values[static_cast<size_t>(metric)]; }
+        uint64_t getDmaWords(uint32_t channel) const { return m_values[METRIC_DMA_WORDS_SLOT + channel]; }
+        uint64_t getGp0Commands(uint8_t opcode) const { return m_values[METRIC_GP0_COMMANDS_SLOT + opcode]; }
+
+        // Aligned "name value" lines, zero GP0 opcodes skipped
+        void writeText(std::ostream& stream) const;
+        // Prometheus text exposition format, counters named epugstation_*_total
+        void writePrometheus(std::ostream& stream) const;
+
+    private:
+        friend MetricsSnapshot getMetrics();
+
+        std::array<uint64_t, METRIC_SLOT_COUNT> m_values{};
+    };
+
+    MetricsSnapshot getMetrics();
+
+    // Writes to a temporary file renamed over "path", so scrapers never read a partial file
+    void saveMetricsPrometheus(const std::string& path);
+}
+#endif
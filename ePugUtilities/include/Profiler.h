@@ -0,0 +1,123 @@
+#ifndef E_PUG_STATION_PROFILER
+#define E_PUG_STATION_PROFILER
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ePugStation
+{
+    struct ProfilerConfig
+    {
+        uint32_t sampleInterval = 1000; // Instructions between samples
+        uint32_t timerInterval = 0;     // Microseconds, samples on a host timer instead when not 0
+        size_t maxDepth = 64;           // Deeper calls are counted but not kept in the stacks
+    };
+
+    // Samples the guest PC, attributed to its basic block (first instruction after a jump) and to its
+    // function (target of the last call still running). Calls and returns are followed from the
+    // executed JAL, JALR and "JR ra", so the stacks need no symbols.
+    class Profiler
+    {
+    public:
+        struct Hotspot
+        {
+            uint32_t address;
+            uint64_t samples;
+        };
+
+        explicit Profiler(const ProfilerConfig& config = {});
+        ~Profiler();
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        // Called after every executed instruction
+        void onInstruction(uint32_t pc, uint32_t instruction)
+        {
+            if (pc != m_lastPc + 4)
+            {
+                m_blockStart = pc;
+            }
+            m_lastPc = pc;
+
+            // The callee starts after the delay slot
+            if (m_pendingCall > 0 && --m_pendingCall == 0)
+            {
+                pushFrame(pc);
+            }
+
+            uint32_t primary = instruction >> 26;
+            uint32_t secondary = instruction & 0x3f;
+            if (primary == JAL || (primary == SPECIAL && secondary == JALR))
+            {
+                m_pendingCall = 2;
+            }
+            else if (primary == SPECIAL && secondary == JR && ((instruction >> 21) & 0x1f) == RA)
+            {
+                popFrame();
+            }
+
+            if (m_config.timerInterval > 0)
+            {
+                if (m_isSampleRequested.load(std::memory_order_relaxed))
+                {
+                    m_isSampleRequested.store(false, std::memory_order_relaxed);
+                    takeSample();
+                }
+            }
+            else if (--m_countdown == 0)
+            {
+                m_countdown = m_config.sampleInterval;
+                takeSample();
+            }
+        }
+
+        uint64_t getSampleCount() const { return m_sampleCount; }
+        size_t getStackDepth() const { return m_stack.size() + m_overflowDepth; }
+
+        // Most sampled first, function 0 is the code running outside of any followed call
+        std::vector<Hotspot> getFunctions() const;
+        std::vector<Hotspot> getBlocks() const;
+
+        // Top functions and blocks with their share of the samples
+        void writeReport(std::ostream& stream, size_t maxEntries = 30) const;
+        // One "root;0x80001000;0x80002000 <samples>" line per distinct stack, for flamegraph.pl
+        void writeFoldedStacks(std::ostream& stream) const;
+
+    private:
+        static constexpr uint32_t SPECIAL = 0x00;
+        static constexpr uint32_t JAL = 0x03;
+        static constexpr uint32_t JR = 0x08;
+        static constexpr uint32_t JALR = 0x09;
+        static constexpr uint32_t RA = 31;
+
+        void pushFrame(uint32_t function);
+        void popFrame();
+        void takeSample();
+
+        ProfilerConfig m_config;
+        uint32_t m_countdown;
+        uint32_t m_lastPc = 0;
+        uint32_t m_blockStart = 0;
+        uint32_t m_pendingCall = 0;
+
+        std::vector<uint32_t> m_stack;
+        size_t m_overflowDepth = 0;
+
+        uint64_t m_sampleCount = 0;
+        std::unordered_map<uint32_t, uint64_t> m_functionSamples;
+        std::unordered_map<uint32_t, uint64_t> m_blockSamples;
+        std::map<std::vector<uint32_t>, uint64_t> m_stackSamples;
+
+        std::atomic<bool> m_isSampleRequested{ false };
+        std::atomic<bool> m_isStopping{ false };
+        std::thread m_timerThread;
+    };
+}
+#endif
@@ -0,0 +1,67 @@
+#ifndef E_PUG_STATION_THREAD_POOL
+#define E_PUG_STATION_THREAD_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ePugStation
+{
+    // Fixed set of workers, each with its own task queue. A worker runs its newest task first, the one
+    // whose data is still in its caches, and steals the oldest task of another worker once its queue
+    // is empty. Long running jobs are best split into tasks that submit their continuation.
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+        // Runs every task left before joining
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // From a worker the task goes to its own queue, from any other thread queues take turns
+        void submit(Task task);
+
+        // Blocks until every task ran, those submitted meanwhile included.
+        // Rethrows the first exception a task threw since the last wait.
+        void wait();
+
+        size_t getThreadCount() const { return m_threads.size(); }
+        uint64_t getStealCount() const { return m_stealCount.load(std::memory_order_relaxed); }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void run(size_t index);
+        bool popTask(size_t index, Task& task);
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_taskAvailable;
+        std::condition_variable m_idle;
+        std::atomic<int64_t> m_queuedCount{ 0 };   // Tasks in a queue, briefly negative while a push is published
+        std::atomic<size_t> m_pendingCount{ 0 };   // Submitted and not finished
+        std::atomic<size_t> m_nextQueue{ 0 };
+        std::atomic<uint64_t> m_stealCount{ 0 };
+        bool m_isStopping = false;
+        std::exception_ptr m_error;
+    };
+}
+#endif
@@ -0,0 +1,57 @@
+#ifndef E_PUG_STATION_TIMELINE
+#define E_PUG_STATION_TIMELINE
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace ePugStation
+{
+    // Events kept per thread, the oldest are overwritten
+    constexpr size_t TIMELINE_RING_SIZE = 64 * 1024; // Power of two
+
+    // Off by default, a disabled timer costs one relaxed load
+    void setTimelineEnabled(bool isEnabled);
+    bool isTimelineEnabled();
+
+    // Nanoseconds since the first timeline use
+    int64_t getTimelineTime();
+
+    // Appends to the ring of the calling thread, never locks once the thread is registered
+    void recordTimelineEvent(const char* name, int64_t start, int64_t end);
+
+    // Every ring as Chrome trace event JSON (chrome://tracing, Perfetto), one track per thread
+    void saveTimeline(const std::string& path);
+
+    // Times its scope, "name" must outlive the timeline (string literals)
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char* name)
+            : m_name(isTimelineEnabled() ? name : nullptr),
+              m_start(m_name ? getTimelineTime() : 0)
+        {}
+
+        ~ScopedTimer()
+        {
+            if (m_name)
+            {
+                recordTimelineEvent(m_name, m_start, getTimelineTime());
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+    };
+}
+
+#define E_PUG_STATION_TIMER_CONCAT_(A, B) A##B
+#define E_PUG_STATION_TIMER_CONCAT(A, B) E_PUG_STATION_TIMER_CONCAT_(A, B)
+#define E_PUG_STATION_TIMER(NAME) ::ePugStation::ScopedTimer E_PUG_STATION_TIMER_CONCAT(scopedTimer, __LINE__)(NAME)
+
+#endif
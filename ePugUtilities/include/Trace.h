@@ -0,0 +1,68 @@
+#ifndef E_PUG_STATION_TRACE
+#define E_PUG_STATION_TRACE
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ePugStation
+{
+    // General purpose registers, then HI and LO
+    constexpr uint32_t TRACE_REGISTER_COUNT = 34;
+    constexpr uint32_t TRACE_HI = 32;
+    constexpr uint32_t TRACE_LO = 33;
+
+    using TraceRegisters = std::array<uint32_t, TRACE_REGISTER_COUNT>;
+
+    // Layout : magic, version, chunk count, then every chunk size and data, oldest first.
+    // A chunk starts with a key frame (instruction index, PC, registers), each record after it is a
+    // flags byte, the PC delta unless sequential, the instruction word and the changed registers deltas.
+    constexpr uint32_t TRACE_MAGIC = 0x52545045; // "EPTR"
+    constexpr uint32_t TRACE_VERSION = 1;
+
+    struct TraceEntry
+    {
+        uint64_t index = 0; // Instructions executed since the recorder was created
+        uint32_t pc = 0;
+        uint32_t instruction = 0;
+        TraceRegisters registers{}; // After the instruction
+    };
+
+    // Ring of delta encoded chunks, the oldest chunk is dropped once "capacity" bytes are used
+    class TraceRecorder
+    {
+    public:
+        explicit TraceRecorder(size_t capacity = 64 * 1024 * 1024, size_t chunkSize = 64 * 1024);
+
+        void record(uint32_t pc, uint32_t instruction, const TraceRegisters& registers);
+
+        uint64_t getRecordCount() const { return m_state.index; }
+        void save(const std::string& path) const;
+
+    private:
+        void startChunk();
+
+        struct Chunk
+        {
+            std::vector<uint8_t> data; // Allocated once, m_chunkSize bytes
+            size_t size = 0;
+        };
+
+        size_t m_chunkSize;
+        size_t m_maxChunks;
+        std::deque<Chunk> m_chunks;
+        TraceEntry m_state; // Last recorded entry, index is the next one
+    };
+
+    // Every entry of a saved trace, oldest first
+    std::vector<TraceEntry> readTrace(const std::string& path);
+
+    // Position in "first" of the first instruction held by both traces that differs, traces are
+    // aligned on the instruction index since ring buffers may have dropped a different amount
+    std::optional<size_t> findFirstDivergence(const std::vector<TraceEntry>& first, const std::vector<TraceEntry>& second);
+}
+#endif
@@ -0,0 +1,57 @@
+#ifndef E_PUG_STATION_TRIPLE_BUFFER
+#define E_PUG_STATION_TRIPLE_BUFFER
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ePugStation
+{
+    // One producer and one consumer exchanging whole values without waiting on each other. The
+    // producer fills the write buffer and publishes it, the consumer picks the newest published one.
+    // Buffers in between are skipped, a slow consumer never holds the producer back.
+    template<typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+        explicit TripleBuffer(const T& initial) : m_buffers{ initial, initial, initial } {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Producer side
+        T& getWriteBuffer() { return m_buffers[m_writeIndex]; }
+
+        void publish()
+        {
+            uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_writeIndex | NEW_FLAG), std::memory_order_acq_rel);
+            m_writeIndex = previous & INDEX_MASK;
+        }
+
+        // Consumer side, true when a buffer was published since the last call
+        bool update()
+        {
+            if (!(m_middle.load(std::memory_order_relaxed) & NEW_FLAG))
+            {
+                return false;
+            }
+            uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+            m_readIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        const T& getReadBuffer() const { return m_buffers[m_readIndex]; }
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 0x3;
+        static constexpr uint8_t NEW_FLAG = 0x4;
+
+        std::array<T, 3> m_buffers;
+        // Each index is only touched by its side, kept on their own cache lines
+        alignas(64) uint8_t m_writeIndex = 0;
+        alignas(64) std::atomic<uint8_t> m_middle{ 1 };
+        alignas(64) uint8_t m_readIndex = 2;
+    };
+}
+#endif
@@ -0,0 +1,35 @@
+#include "Compression.h"
+
+#include <lz4.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace ePugStation
+{
+    size_t compressBound(size_t size)
+    {
+        return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+    }
+
+    size_t compress(const void* data, size_t size, void* output, size_t capacity)
+    {
+        int compressedSize = LZ4_compress_default(static_cast<const char*>(data), static_cast<char*>(output),
+                                                  static_cast<int>(size), static_cast<int>(capacity));
+        if (compressedSize <= 0)
+        {
+            throw std::runtime_error("LZ4 compression failed for " + std::to_string(size) + " bytes");
+        }
+        return static_cast<size_t>(compressedSize);
+    }
+
+    void decompress(const void* data, size_t compressedSize, void* output, size_t size)
+    {
+        int decodedSize = LZ4_decompress_safe(static_cast<const char*>(data), static_cast<char*>(output),
+                                              static_cast<int>(compressedSize), static_cast<int>(size));
+        if (decodedSize < 0 || static_cast<size_t>(decodedSize) != size)
+        {
+            throw std::runtime_error("LZ4 decompression failed, expected " + std::to_string(size) + " bytes");
+        }
+    }
+}
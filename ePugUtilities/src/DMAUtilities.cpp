@@ -0,0 +1,100 @@
+#include "DMAUtilities.h"
+#include "Constants.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t RAM_WORD_COUNT = ePugStation::RAM_SIZE / 4;
+    constexpr uint32_t RAM_ADDRESS_MASK = 0x1ffffc;
+    constexpr uint32_t ORDERING_TABLE_END = 0xffffff;
+
+    // Words [first, first + count) each get the address of the word before them.
+    // Run must not contain word 0 (its previous word wraps to the end of RAM).
+    void fillPreviousAddresses(uint32_t* ram, uint32_t first, uint32_t count)
+    {
+        uint32_t index = first;
+        const uint32_t end = first + count;
+
+#if defined(__AVX2__)
+        __m256i value = _mm256_setr_epi32((index - 1) * 4, index * 4, (index + 1) * 4, (index + 2) * 4,
+                                          (index + 3) * 4, (index + 4) * 4, (index + 5) * 4, (index + 6) * 4);
+        const __m256i step = _mm256_set1_epi32(8 * 4);
+        for (; index + 8 <= end; index += 8)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(ram + index), value);
+            value = _mm256_add_epi32(value, step);
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        __m128i value = _mm_setr_epi32((index - 1) * 4, index * 4, (index + 1) * 4, (index + 2) * 4);
+        const __m128i step = _mm_set1_epi32(4 * 4);
+        for (; index + 4 <= end; index += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ram + index), value);
+            value = _mm_add_epi32(value, step);
+        }
+#endif
+        for (; index < end; ++index)
+        {
+            ram[index] = (index - 1) * 4;
+        }
+    }
+
+    void fillRun(uint32_t* ram, uint32_t first, uint32_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (first == 0)
+        {
+            ram[0] = RAM_ADDRESS_MASK & static_cast<uint32_t>(-4);
+            ++first;
+            --count;
+        }
+        fillPreviousAddresses(ram, first, count);
+    }
+}
+
+namespace ePugStation
+{
+    void clearOrderingTable(uint32_t* ram, uint32_t address, uint32_t entries)
+    {
+        if (entries == 0)
+        {
+            return;
+        }
+
+        uint32_t highest = (address & RAM_ADDRESS_MASK) >> 2;
+        if (entries > RAM_WORD_COUNT)
+        {
+            // Longer tables overwrite every word of RAM, keep the last lap ending on the end marker
+            const uint32_t last = (highest + RAM_WORD_COUNT - (entries - 1) % RAM_WORD_COUNT) % RAM_WORD_COUNT;
+            highest = (last + RAM_WORD_COUNT - 1) % RAM_WORD_COUNT;
+            entries = RAM_WORD_COUNT;
+        }
+
+        const uint32_t below = entries - 1; // Entries under the start address
+        uint32_t lowest = 0;
+
+        if (below <= highest)
+        {
+            lowest = highest - below;
+            fillRun(ram, lowest, entries);
+        }
+        else
+        {
+            // Table wraps under address 0 to the end of RAM
+            uint32_t wrapped = below - highest;
+            lowest = RAM_WORD_COUNT - wrapped;
+            fillRun(ram, 0, highest + 1);
+            fillRun(ram, lowest, wrapped);
+        }
+
+        ram[lowest] = ORDERING_TABLE_END;
+    }
+}
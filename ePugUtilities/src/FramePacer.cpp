@@ -0,0 +1,73 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+namespace
+{
+    // A throttled run that fell this many frames behind (debugger, window drag) restarts from now
+    // instead of running the missed frames unthrottled
+    constexpr int MAX_LATE_FRAMES = 4;
+}
+
+namespace ePugStation
+{
+    FramePacer::FramePacer(double refreshRate, Clock::duration measureInterval)
+        : m_measureInterval(measureInterval)
+    {
+        setRefreshRate(refreshRate);
+        m_deadline = Clock::now() + m_framePeriod;
+        m_measureStart = Clock::now();
+    }
+
+    void FramePacer::setRefreshRate(double refreshRate)
+    {
+        m_framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+    }
+
+    void FramePacer::setThrottled(bool isThrottled)
+    {
+        if (isThrottled && !m_isThrottled)
+        {
+            m_deadline = Clock::now() + m_framePeriod;
+        }
+        m_isThrottled = isThrottled;
+    }
+
+    bool FramePacer::endFrame()
+    {
+        auto now = Clock::now();
+        if (m_isThrottled)
+        {
+            if (now < m_deadline)
+            {
+                std::this_thread::sleep_until(m_deadline);
+                now = Clock::now();
+                m_deadline += m_framePeriod;
+            }
+            else if (now - m_deadline > MAX_LATE_FRAMES * m_framePeriod)
+            {
+                m_deadline = now + m_framePeriod;
+            }
+            else
+            {
+                m_deadline += m_framePeriod;
+            }
+        }
+
+        ++m_measuredFrames;
+        m_emulatedTime += m_framePeriod;
+        auto elapsed = now - m_measureStart;
+        if (elapsed < m_measureInterval)
+        {
+            return false;
+        }
+
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        m_speed = std::chrono::duration<double>(m_emulatedTime).count() / seconds;
+        m_frameRate = static_cast<double>(m_measuredFrames) / seconds;
+        m_measureStart = now;
+        m_measuredFrames = 0;
+        m_emulatedTime = Clock::duration::zero();
+        return true;
+    }
+}
@@ -0,0 +1,190 @@
+#include "Hash.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define E_PUG_STATION_CRC32C_SSE42
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define E_PUG_STATION_TARGET_SSE42
+#else
+// Built without -msse4.2, the instruction is only used after checking the CPU
+#define E_PUG_STATION_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+namespace
+{
+    constexpr uint64_t PRIME_1 = 0x9e3779b185ebca87ULL;
+    constexpr uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+    constexpr uint64_t PRIME_3 = 0x165667b19e3779f9ULL;
+    constexpr uint64_t PRIME_4 = 0x85ebca77c2b2ae63ULL;
+    constexpr uint64_t PRIME_5 = 0x27d4eb2f165667c5ULL;
+
+    uint64_t rotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Little endian, like every host we build for
+    uint64_t read64(const uint8_t* data)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t read32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * PRIME_2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * PRIME_1;
+    }
+
+    uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= round(0, value);
+        return accumulator * PRIME_1 + PRIME_4;
+    }
+
+    constexpr uint32_t CRC32C_POLYNOMIAL = 0x82f63b78; // Reflected
+
+    const std::array<uint32_t, 256> CRC32C_TABLE = []
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t byte = 0; byte < 256; ++byte)
+        {
+            uint32_t crc = byte;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
+            }
+            table[byte] = crc;
+        }
+        return table;
+    }();
+
+    uint32_t crc32cSoftware(const uint8_t* data, size_t size, uint32_t crc)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = CRC32C_TABLE[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+#if defined(E_PUG_STATION_CRC32C_SSE42)
+    E_PUG_STATION_TARGET_SSE42 uint32_t crc32cHardware(const uint8_t* data, size_t size, uint32_t crc)
+    {
+        uint64_t crc64 = crc;
+        for (; size >= 8; size -= 8, data += 8)
+        {
+            crc64 = _mm_crc32_u64(crc64, read64(data));
+        }
+        crc = static_cast<uint32_t>(crc64);
+        for (; size > 0; --size, ++data)
+        {
+            crc = _mm_crc32_u8(crc, *data);
+        }
+        return crc;
+    }
+
+    bool hasSse42()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+#else
+        return __builtin_cpu_supports("sse4.2");
+#endif
+    }
+
+    const bool HAS_SSE42 = hasSse42();
+#endif
+}
+
+namespace ePugStation
+{
+    uint64_t hash64(const void* data, size_t size, uint64_t seed)
+    {
+        const uint8_t* input = static_cast<const uint8_t*>(data);
+        const uint8_t* end = input + size;
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            // Four independent lanes, so the multiplications overlap
+            uint64_t lane1 = seed + PRIME_1 + PRIME_2;
+            uint64_t lane2 = seed + PRIME_2;
+            uint64_t lane3 = seed;
+            uint64_t lane4 = seed - PRIME_1;
+            const uint8_t* limit = end - 32;
+            do
+            {
+                lane1 = round(lane1, read64(input));
+                lane2 = round(lane2, read64(input + 8));
+                lane3 = round(lane3, read64(input + 16));
+                lane4 = round(lane4, read64(input + 24));
+                input += 32;
+            } while (input <= limit);
+
+            hash = rotateLeft(lane1, 1) + rotateLeft(lane2, 7) + rotateLeft(lane3, 12) + rotateLeft(lane4, 18);
+            hash = mergeRound(hash, lane1);
+            hash = mergeRound(hash, lane2);
+            hash = mergeRound(hash, lane3);
+            hash = mergeRound(hash, lane4);
+        }
+        else
+        {
+            hash = seed + PRIME_5;
+        }
+
+        hash += static_cast<uint64_t>(size);
+
+        for (; input + 8 <= end; input += 8)
+        {
+            hash ^= round(0, read64(input));
+            hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+        }
+        if (input + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(read32(input)) * PRIME_1;
+            hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+            input += 4;
+        }
+        for (; input < end; ++input)
+        {
+            hash ^= (*input) * PRIME_5;
+            hash = rotateLeft(hash, 11) * PRIME_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint32_t crc32c(const void* data, size_t size, uint32_t crc)
+    {
+        const uint8_t* input = static_cast<const uint8_t*>(data);
+#if defined(E_PUG_STATION_CRC32C_SSE42)
+        if (HAS_SSE42)
+        {
+            return ~crc32cHardware(input, size, ~crc);
+        }
+#endif
+        return ~crc32cSoftware(input, size, ~crc);
+    }
+}
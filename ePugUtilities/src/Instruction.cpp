@@ -0,0 +1,104 @@
+#include "Instruction.h"
+
+namespace ePugStation
+{
+    namespace
+    {
+        Opcode decodeSubOp(SecondaryOp op)
+        {
+            switch (op)
+            {
+            case SecondaryOp::opSLL: return Opcode::SLL;
+            case SecondaryOp::opSRL: return Opcode::SRL;
+            case SecondaryOp::opSRA: return Opcode::SRA;
+            case SecondaryOp::opSLLV: return Opcode::SLLV;
+            case SecondaryOp::opSRLV: return Opcode::SRLV;
+            case SecondaryOp::opSRAV: return Opcode::SRAV;
+            case SecondaryOp::opJR: return Opcode::JR;
+            case SecondaryOp::opJALR: return Opcode::JALR;
+            case SecondaryOp::opSYSCALL: return Opcode::SYSCALL;
+            case SecondaryOp::opBREAK: return Opcode::BREAK;
+            case SecondaryOp::opMFHI: return Opcode::MFHI;
+            case SecondaryOp::opMTHI: return Opcode::MTHI;
+            case SecondaryOp::opMFLO: return Opcode::MFLO;
+            case SecondaryOp::opMTLO: return Opcode::MTLO;
+            case SecondaryOp::opMULT: return Opcode::MULT;
+            case SecondaryOp::opMULTU: return Opcode::MULTU;
+            case SecondaryOp::opDIV: return Opcode::DIV;
+            case SecondaryOp::opDIVU: return Opcode::DIVU;
+            case SecondaryOp::opADD: return Opcode::ADD;
+            case SecondaryOp::opADDU: return Opcode::ADDU;
+            case SecondaryOp::opSUB: return Opcode::SUB;
+            case SecondaryOp::opSUBU: return Opcode::SUBU;
+            case SecondaryOp::opAND: return Opcode::AND;
+            case SecondaryOp::opOR: return Opcode::OR;
+            case SecondaryOp::opXOR: return Opcode::XOR;
+            case SecondaryOp::opNOR: return Opcode::NOR;
+            case SecondaryOp::opSLT: return Opcode::SLT;
+            case SecondaryOp::opSLTU: return Opcode::SLTU;
+            default: return Opcode::InvalidSubOp;
+            }
+        }
+
+        Opcode decodeBranchOp(uint32_t t)
+        {
+            switch (t)
+            {
+            case 0b00000: return Opcode::BLTZ;
+            case 0b00001: return Opcode::BGEZ;
+            case 0b10000: return Opcode::BLTZAL;
+            case 0b10001: return Opcode::BGEZAL;
+            default: return Opcode::InvalidBranchOp;
+            }
+        }
+    }
+
+    Opcode decodeOpcode(uint32_t word)
+    {
+        Instruction instruction(word);
+        switch (instruction.op.primary)
+        {
+        case PrimaryOp::SubOp: return decodeSubOp(instruction.op.seconday);
+        case PrimaryOp::BranchOp: return decodeBranchOp(instruction.reg.t);
+        case PrimaryOp::opJ: return Opcode::J;
+        case PrimaryOp::opJAL: return Opcode::JAL;
+        case PrimaryOp::opBEQ: return Opcode::BEQ;
+        case PrimaryOp::opBNE: return Opcode::BNE;
+        case PrimaryOp::opBLEZ: return Opcode::BLEZ;
+        case PrimaryOp::opBGTZ: return Opcode::BGTZ;
+        case PrimaryOp::opADDI: return Opcode::ADDI;
+        case PrimaryOp::opADDIU: return Opcode::ADDIU;
+        case PrimaryOp::opSLTI: return Opcode::SLTI;
+        case PrimaryOp::opSLTIU: return Opcode::SLTIU;
+        case PrimaryOp::opANDI: return Opcode::ANDI;
+        case PrimaryOp::opORI: return Opcode::ORI;
+        case PrimaryOp::opXORI: return Opcode::XORI;
+        case PrimaryOp::opCop0: return Opcode::Cop0;
+        case PrimaryOp::opCop1: return Opcode::Cop1;
+        case PrimaryOp::opCop2: return Opcode::Cop2;
+        case PrimaryOp::opCop3: return Opcode::Cop3;
+        case PrimaryOp::opLUI: return Opcode::LUI;
+        case PrimaryOp::opLB: return Opcode::LB;
+        case PrimaryOp::opLBU: return Opcode::LBU;
+        case PrimaryOp::opLH: return Opcode::LH;
+        case PrimaryOp::opLWL: return Opcode::LWL;
+        case PrimaryOp::opLW: return Opcode::LW;
+        case PrimaryOp::opLHU: return Opcode::LHU;
+        case PrimaryOp::opLWR: return Opcode::LWR;
+        case PrimaryOp::opSB: return Opcode::SB;
+        case PrimaryOp::opSH: return Opcode::SH;
+        case PrimaryOp::opSWL: return Opcode::SWL;
+        case PrimaryOp::opSW: return Opcode::SW;
+        case PrimaryOp::opSWR: return Opcode::SWR;
+        case PrimaryOp::opLWC0: return Opcode::LWC0;
+        case PrimaryOp::opLWC1: return Opcode::LWC1;
+        case PrimaryOp::opLWC2: return Opcode::LWC2;
+        case PrimaryOp::opLWC3: return Opcode::LWC3;
+        case PrimaryOp::opSWC0: return Opcode::SWC0;
+        case PrimaryOp::opSWC1: return Opcode::SWC1;
+        case PrimaryOp::opSWC2: return Opcode::SWC2;
+        case PrimaryOp::opSWC3: return Opcode::SWC3;
+        default: return Opcode::InvalidPrimary;
+        }
+    }
+}
@@ -0,0 +1,288 @@
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ePugStation
+{
+    namespace
+    {
+        constexpr size_t LOG_QUEUE_SIZE = 1024; // Power of two
+        constexpr size_t LOG_MESSAGE_SIZE = 240;
+        constexpr int64_t RATE_LIMIT_PERIOD = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)).count();
+
+        const char* LEVEL_NAMES[] = { "trace", "debug", "info", "warning", "error", "off" };
+        const char* SUBSYSTEM_NAMES[] = { "CPU", "Memory", "DMA", "GPU", "Renderer", "SaveState", "Frontend" };
+        static_assert(std::size(SUBSYSTEM_NAMES) == static_cast<size_t>(LogSubsystem::Count));
+
+        std::atomic<LogLevel> g_levels[] = { LogLevel::Info, LogLevel::Info, LogLevel::Info, LogLevel::Info,
+                                             LogLevel::Info, LogLevel::Info, LogLevel::Info };
+        static_assert(std::size(g_levels) == static_cast<size_t>(LogSubsystem::Count));
+
+        // Constant initialized, so sites constructed during static initialization can register
+        std::atomic<LogSite*> g_sites{ nullptr };
+
+        int64_t now()
+        {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        void printToStdout(LogLevel level, LogSubsystem subsystem, const char* message)
+        {
+            std::printf("[%s][%s] %s\n", LEVEL_NAMES[static_cast<size_t>(level)], SUBSYSTEM_NAMES[static_cast<size_t>(subsystem)], message);
+        }
+    }
+
+    // Bounded multi producer queue (sequence number per slot), drained by a single thread.
+    // Producers never lock nor wait, a full queue drops the message.
+    class Logger
+    {
+    public:
+        Logger() : m_enqueuePosition(0), m_consumed(0), m_dropped(0), m_isStopping(false), m_sink(printToStdout)
+        {
+            for (size_t i = 0; i < LOG_QUEUE_SIZE; ++i)
+            {
+                m_entries[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_thread = std::thread(&Logger::run, this);
+        }
+
+        ~Logger()
+        {
+            m_isStopping.store(true, std::memory_order_release);
+            m_thread.join();
+            std::fflush(stdout);
+        }
+
+        void push(LogSite& site, const char* format, va_list arguments)
+        {
+            uint64_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            Entry* entry;
+            while (true)
+            {
+                entry = &m_entries[position & (LOG_QUEUE_SIZE - 1)];
+                uint64_t sequence = entry->sequence.load(std::memory_order_acquire);
+                int64_t difference = static_cast<int64_t>(sequence - position);
+                if (difference == 0)
+                {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            entry->site = &site;
+            entry->suppressed = site.takeSuppressed();
+            std::vsnprintf(entry->message, LOG_MESSAGE_SIZE, format, arguments);
+            entry->sequence.store(position + 1, std::memory_order_release);
+        }
+
+        void flush()
+        {
+            uint64_t target = m_enqueuePosition.load(std::memory_order_acquire);
+            while (m_consumed.load(std::memory_order_acquire) < target)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            std::fflush(stdout);
+        }
+
+        void setSink(LogSink sink)
+        {
+            flush();
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            m_sink = sink ? std::move(sink) : LogSink(printToStdout);
+        }
+
+        uint64_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Entry
+        {
+            std::atomic<uint64_t> sequence;
+            LogSite* site;
+            uint64_t suppressed;
+            char message[LOG_MESSAGE_SIZE];
+        };
+
+        void run()
+        {
+            uint64_t position = 0;
+            while (true)
+            {
+                // Read the flag first, so nothing pushed before the stop request is lost
+                bool isStopping = m_isStopping.load(std::memory_order_acquire);
+                bool hasConsumed = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_sinkMutex);
+                    while (consume(position))
+                    {
+                        ++position;
+                        m_consumed.store(position, std::memory_order_release);
+                        hasConsumed = true;
+                    }
+                }
+
+                if (isStopping)
+                {
+                    return;
+                }
+                if (!hasConsumed)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        bool consume(uint64_t position)
+        {
+            Entry& entry = m_entries[position & (LOG_QUEUE_SIZE - 1)];
+            if (entry.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                return false;
+            }
+
+            if (entry.suppressed > 0)
+            {
+                char message[LOG_MESSAGE_SIZE + 32];
+                std::snprintf(message, sizeof(message), "%s (%llu more suppressed)", entry.message, static_cast<unsigned long long>(entry.suppressed));
+                m_sink(entry.site->getLevel(), entry.site->getSubsystem(), message);
+            }
+            else
+            {
+                m_sink(entry.site->getLevel(), entry.site->getSubsystem(), entry.message);
+            }
+            entry.sequence.store(position + LOG_QUEUE_SIZE, std::memory_order_release);
+            return true;
+        }
+
+        std::array<Entry, LOG_QUEUE_SIZE> m_entries;
+        alignas(64) std::atomic<uint64_t> m_enqueuePosition;
+        alignas(64) std::atomic<uint64_t> m_consumed;
+        std::atomic<uint64_t> m_dropped;
+        std::atomic<bool> m_isStopping;
+
+        std::mutex m_sinkMutex; // Logging thread and sink changes only, never taken by producers
+        LogSink m_sink;
+        std::thread m_thread;
+    };
+
+    namespace
+    {
+        Logger& getLogger()
+        {
+            static Logger logger;
+            return logger;
+        }
+    }
+
+    LogSite::LogSite(LogLevel level, LogSubsystem subsystem, const char* file, int line)
+        : m_level(level),
+          m_subsystem(subsystem),
+          m_file(file),
+          m_line(line),
+          m_count(0),
+          m_suppressed(0),
+          m_lastMessageTime(0),
+          m_next(g_sites.load(std::memory_order_relaxed))
+    {
+        while (!g_sites.compare_exchange_weak(m_next, this, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    bool LogSite::shouldLog()
+    {
+        if (m_level < getLogLevel(m_subsystem))
+        {
+            return false;
+        }
+
+        uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+        if (count < LOG_BURST)
+        {
+            // The rate limit period starts with the last message of the burst
+            if (count == LOG_BURST - 1)
+            {
+                m_lastMessageTime.store(now(), std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        int64_t time = now();
+        int64_t lastMessageTime = m_lastMessageTime.load(std::memory_order_relaxed);
+        if (time - lastMessageTime >= RATE_LIMIT_PERIOD &&
+            m_lastMessageTime.compare_exchange_strong(lastMessageTime, time, std::memory_order_relaxed))
+        {
+            return true;
+        }
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void setLogLevel(LogSubsystem subsystem, LogLevel level)
+    {
+        g_levels[static_cast<size_t>(subsystem)].store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel getLogLevel(LogSubsystem subsystem)
+    {
+        return g_levels[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+    }
+
+    void setLogSink(LogSink sink)
+    {
+        getLogger().setSink(std::move(sink));
+    }
+
+    void log(LogSite& site, const char* format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        getLogger().push(site, format, arguments);
+        va_end(arguments);
+    }
+
+    void flushLog()
+    {
+        getLogger().flush();
+    }
+
+    void printLogSummary()
+    {
+        std::vector<const LogSite*> sites;
+        for (const LogSite* site = g_sites.load(std::memory_order_acquire); site; site = site->getNext())
+        {
+            if (site->getCount() > 0)
+            {
+                sites.push_back(site);
+            }
+        }
+        std::sort(sites.begin(), sites.end(), [](const LogSite* a, const LogSite* b) { return a->getCount() > b->getCount(); });
+
+        flushLog();
+        std::printf("Log summary, %llu messages dropped on a full queue\n", static_cast<unsigned long long>(getLogger().getDropped()));
+        for (const LogSite* site : sites)
+        {
+            std::printf("%10llu %s:%d\n", static_cast<unsigned long long>(site->getCount()), site->getFile(), site->getLine());
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    using namespace ePugStation;
+
+    struct MetricInfo
+    {
+        const char* text;
+        const char* name; // Prometheus name, shared by neighbours told apart by their label
+        const char* help;
+        const char* label;
+    };
+
+    const MetricInfo METRIC_INFOS[] = {
+        { "Instructions", "instructions", "Instructions executed", nullptr },
+        { "RAM accesses", "memory_accesses", "Interconnect loads and stores", "region=\"ram\"" },
+        { "BIOS accesses", "memory_accesses", "Interconnect loads and stores", "region=\"bios\"" },
+        { "MMIO accesses", "memory_accesses", "Interconnect loads and stores", "region=\"mmio\"" },
+        { "Exceptions", "exceptions", "CPU exceptions raised", nullptr },
+        { "Vertices", "vertices", "Vertices pushed to the renderer", nullptr },
+        { "Draw calls", "draw_calls", "Renderer draw calls", nullptr },
+        { "VRAM bytes uploaded", "vram_upload_bytes", "VRAM bytes uploaded to the host GPU", nullptr }
+    };
+    static_assert(std::size(METRIC_INFOS) == static_cast<size_t>(Metric::Count));
+
+    // Live blocks, and the counts of the threads that exited
+    std::mutex g_registryMutex;
+    std::vector<MetricBlock*> g_blocks;
+    std::array<uint64_t, METRIC_SLOT_COUNT> g_retired{};
+
+    // Folds the thread counts into the retired ones when the thread exits
+    struct ThreadRegistration
+    {
+        std::unique_ptr<MetricBlock> block = std::make_unique<MetricBlock>();
+
+        ThreadRegistration()
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            g_blocks.push_back(block.get());
+        }
+
+        ~ThreadRegistration()
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            for (size_t slot = 0; slot < METRIC_SLOT_COUNT; ++slot)
+            {
+                g_retired[slot] += block->values[slot].load(std::memory_order_relaxed);
+            }
+            g_blocks.erase(std::find(g_blocks.begin(), g_blocks.end(), block.get()));
+            t_metricBlock = nullptr;
+        }
+    };
+
+    void writeTextLine(std::ostream& stream, const char* name, uint64_t value)
+    {
+        char line[96];
+        std::snprintf(line, sizeof(line), "%-44s %llu\n", name, static_cast<unsigned long long>(value));
+        stream << line;
+    }
+
+    void writePrometheusHeader(std::ostream& stream, const char* name, const char* help)
+    {
+        stream << "# HELP epugstation_" << name << "_total " << help << "\n";
+        stream << "# TYPE epugstation_" << name << "_total counter\n";
+    }
+}
+
+namespace ePugStation
+{
+    MetricBlock* registerMetricThread()
+    {
+        thread_local ThreadRegistration registration;
+        t_metricBlock = registration.block.get();
+        return t_metricBlock;
+    }
+
+    MetricsSnapshot getMetrics()
+    {
+        MetricsSnapshot snapshot;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        snapshot.m_values = g_retired;
+        for (const MetricBlock* block : g_blocks)
+        {
+            for (size_t slot = 0; slot < METRIC_SLOT_COUNT; ++slot)
+            {
+                snapshot.m_values[slot] += block->values[slot].load(std::memory_order_relaxed);
+            }
+        }
+        return snapshot;
+    }
+
+    void MetricsSnapshot::writeText(std::ostream& stream) const
+    {
+        char name[64];
+        for (size_t slot = 0; slot < static_cast<size_t>(Metric::Count); ++slot)
+        {
+            writeTextLine(stream, METRIC_INFOS[slot].text, m_values[slot]);
+        }
+        for (uint32_t channel = 0; channel < METRIC_DMA_CHANNELS; ++channel)
+        {
+            std::snprintf(name, sizeof(name), "DMA words, channel %u", channel);
+            writeTextLine(stream, name, getDmaWords(channel));
+        }
+        for (uint32_t opcode = 0; opcode < METRIC_GP0_OPCODES; ++opcode)
+        {
+            if (uint64_t count = getGp0Commands(static_cast<uint8_t>(opcode)))
+            {
+                std::snprintf(name, sizeof(name), "GP0 commands, opcode 0x%02x", opcode);
+                writeTextLine(stream, name, count);
+            }
+        }
+    }
+
+    void MetricsSnapshot::writePrometheus(std::ostream& stream) const
+    {
+        const char* previousName = nullptr;
+        for (size_t slot = 0; slot < static_cast<size_t>(Metric::Count); ++slot)
+        {
+            const MetricInfo& info = METRIC_INFOS[slot];
+            if (!previousName || std::strcmp(previousName, info.name) != 0)
+            {
+                writePrometheusHeader(stream, info.name, info.help);
+            }
+            previousName = info.name;
+
+            stream << "epugstation_" << info.name << "_total";
+            if (info.label)
+            {
+                stream << "{" << info.label << "}";
+            }
+            stream << " " << m_values[slot] << "\n";
+        }
+
+        writePrometheusHeader(stream, "dma_words", "Words moved by DMA");
+        for (uint32_t channel = 0; channel < METRIC_DMA_CHANNELS; ++channel)
+        {
+            stream << "epugstation_dma_words_total{channel=\"" << channel << "\"} " << getDmaWords(channel) << "\n";
+        }
+
+        writePrometheusHeader(stream, "gp0_commands", "GP0 commands started");
+        char opcodeText[8];
+        for (uint32_t opcode = 0; opcode < METRIC_GP0_OPCODES; ++opcode)
+        {
+            if (uint64_t count = getGp0Commands(static_cast<uint8_t>(opcode)))
+            {
+                std::snprintf(opcodeText, sizeof(opcodeText), "0x%02x", opcode);
+                stream << "epugstation_gp0_commands_total{opcode=\"" << opcodeText << "\"} " << count << "\n";
+            }
+        }
+    }
+
+    void saveMetricsPrometheus(const std::string& path)
+    {
+        std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream file(temporaryPath);
+            if (!file)
+            {
+                throw std::runtime_error("Could not create metrics file : " + temporaryPath);
+            }
+            getMetrics().writePrometheus(file);
+        }
+        // Replaces an existing file on every platform, std::rename fails on Windows
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            throw std::runtime_error("Could not replace metrics file : " + path + " (" + error.message() + ")");
+        }
+    }
+}
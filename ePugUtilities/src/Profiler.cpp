@@ -0,0 +1,145 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    using namespace ePugStation;
+
+    std::vector<Profiler::Hotspot> sortHotspots(const std::unordered_map<uint32_t, uint64_t>& samples)
+    {
+        std::vector<Profiler::Hotspot> hotspots;
+        hotspots.reserve(samples.size());
+        for (const auto& [address, count] : samples)
+        {
+            hotspots.push_back({ address, count });
+        }
+        std::sort(hotspots.begin(), hotspots.end(), [](const Profiler::Hotspot& a, const Profiler::Hotspot& b)
+        {
+            return a.samples != b.samples ? a.samples > b.samples : a.address < b.address;
+        });
+        return hotspots;
+    }
+
+    std::string formatAddress(uint32_t address)
+    {
+        char text[16];
+        std::snprintf(text, sizeof(text), "0x%08x", address);
+        return text;
+    }
+
+    void writeHotspots(std::ostream& stream, const char* title, const std::vector<Profiler::Hotspot>& hotspots,
+                       uint64_t sampleCount, size_t maxEntries)
+    {
+        stream << title << "\n  samples       %  address\n";
+        for (size_t i = 0; i < std::min(maxEntries, hotspots.size()); ++i)
+        {
+            char line[64];
+            std::snprintf(line, sizeof(line), "%9llu  %6.2f  ", static_cast<unsigned long long>(hotspots[i].samples),
+                          100.0 * static_cast<double>(hotspots[i].samples) / static_cast<double>(sampleCount));
+            stream << line << (hotspots[i].address ? formatAddress(hotspots[i].address) : "root") << "\n";
+        }
+    }
+}
+
+namespace ePugStation
+{
+    Profiler::Profiler(const ProfilerConfig& config)
+        : m_config(config),
+          m_countdown(std::max<uint32_t>(config.sampleInterval, 1))
+    {
+        m_config.sampleInterval = m_countdown;
+        m_stack.reserve(m_config.maxDepth);
+        if (m_config.timerInterval > 0)
+        {
+            m_timerThread = std::thread([this]
+            {
+                while (!m_isStopping.load(std::memory_order_relaxed))
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(m_config.timerInterval));
+                    m_isSampleRequested.store(true, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+
+    Profiler::~Profiler()
+    {
+        m_isStopping.store(true, std::memory_order_relaxed);
+        if (m_timerThread.joinable())
+        {
+            m_timerThread.join();
+        }
+    }
+
+    std::vector<Profiler::Hotspot> Profiler::getFunctions() const
+    {
+        return sortHotspots(m_functionSamples);
+    }
+
+    std::vector<Profiler::Hotspot> Profiler::getBlocks() const
+    {
+        return sortHotspots(m_blockSamples);
+    }
+
+    void Profiler::writeReport(std::ostream& stream, size_t maxEntries) const
+    {
+        stream << "Guest profile, " << m_sampleCount << " samples\n\n";
+        if (m_sampleCount == 0)
+        {
+            return;
+        }
+        writeHotspots(stream, "Functions", getFunctions(), m_sampleCount, maxEntries);
+        stream << "\n";
+        writeHotspots(stream, "Basic blocks", getBlocks(), m_sampleCount, maxEntries);
+    }
+
+    void Profiler::writeFoldedStacks(std::ostream& stream) const
+    {
+        for (const auto& [stack, count] : m_stackSamples)
+        {
+            stream << "root";
+            for (uint32_t function : stack)
+            {
+                stream << ';' << formatAddress(function);
+            }
+            stream << ' ' << count << "\n";
+        }
+    }
+
+    void Profiler::pushFrame(uint32_t function)
+    {
+        if (m_stack.size() < m_config.maxDepth)
+        {
+            m_stack.push_back(function);
+        }
+        else
+        {
+            ++m_overflowDepth;
+        }
+    }
+
+    void Profiler::popFrame()
+    {
+        // Returns without a followed call (from code running before profiling started) are ignored
+        if (m_overflowDepth > 0)
+        {
+            --m_overflowDepth;
+        }
+        else if (!m_stack.empty())
+        {
+            m_stack.pop_back();
+        }
+    }
+
+    void Profiler::takeSample()
+    {
+        ++m_sampleCount;
+        ++m_functionSamples[m_stack.empty() ? 0 : m_stack.back()];
+        ++m_blockSamples[m_blockStart];
+        ++m_stackSamples[m_stack];
+    }
+}
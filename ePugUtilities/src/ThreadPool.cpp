@@ -0,0 +1,139 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+    using namespace ePugStation;
+
+    // Pool and queue of the calling worker thread
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local size_t t_queueIndex = 0;
+}
+
+namespace ePugStation
+{
+    ThreadPool::ThreadPool(size_t threadCount)
+    {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            m_threads.emplace_back([this, index] { run(index); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isStopping = true;
+        }
+        m_taskAvailable.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        size_t index = t_pool == this ? t_queueIndex : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // Counted under the lock the workers sleep with, so none misses the wake up
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queuedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_taskAvailable.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_pendingCount.load(std::memory_order_acquire) == 0; });
+        if (m_error)
+        {
+            std::exception_ptr error = std::move(m_error);
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::run(size_t index)
+    {
+        t_pool = this;
+        t_queueIndex = index;
+        Task task;
+        while (true)
+        {
+            if (!popTask(index, task))
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskAvailable.wait(lock, [this] { return m_queuedCount.load(std::memory_order_relaxed) > 0 || m_isStopping; });
+                if (m_isStopping && m_queuedCount.load(std::memory_order_relaxed) <= 0)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                {
+                    m_error = std::current_exception();
+                }
+            }
+            task = nullptr;
+
+            if (m_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_idle.notify_all();
+            }
+        }
+    }
+
+    bool ThreadPool::popTask(size_t index, Task& task)
+    {
+        {
+            Queue& queue = *m_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < m_queues.size(); ++offset)
+        {
+            Queue& queue = *m_queues[(index + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+                m_stealCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,155 @@
+#include "Timeline.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    using namespace ePugStation;
+
+    // Fields are atomic so the exporter may read a slot while its thread overwrites it
+    struct Event
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<int64_t> start{ 0 };
+        std::atomic<int64_t> end{ 0 };
+    };
+
+    // Single writer ring, "head" counts every event ever written
+    struct Ring
+    {
+        uint32_t threadIndex = 0;
+        std::atomic<uint64_t> head{ 0 };
+        std::array<Event, TIMELINE_RING_SIZE> events;
+    };
+
+    struct EventCopy
+    {
+        const char* name;
+        int64_t start;
+        int64_t end;
+    };
+
+    std::atomic<bool> g_isEnabled{ false };
+    const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+    // Rings are never freed, so events of exited threads are still exported
+    std::mutex g_ringsMutex;
+    std::vector<std::unique_ptr<Ring>> g_rings;
+
+    thread_local Ring* t_ring = nullptr;
+
+    Ring* registerThread()
+    {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        g_rings.push_back(std::make_unique<Ring>());
+        g_rings.back()->threadIndex = static_cast<uint32_t>(g_rings.size());
+        t_ring = g_rings.back().get();
+        return t_ring;
+    }
+
+    std::vector<EventCopy> copyEvents(const Ring& ring)
+    {
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t first = head > TIMELINE_RING_SIZE ? head - TIMELINE_RING_SIZE : 0;
+
+        std::vector<EventCopy> events;
+        events.reserve(static_cast<size_t>(head - first));
+        for (uint64_t index = first; index < head; ++index)
+        {
+            const Event& event = ring.events[index & (TIMELINE_RING_SIZE - 1)];
+            events.push_back({ event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed),
+                               event.end.load(std::memory_order_relaxed) });
+        }
+
+        // Drop the slots the thread overwrote during the copy, and the one it may be writing.
+        // The fence keeps the relaxed event loads above from moving past the head re-read.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = ring.head.load(std::memory_order_relaxed) + 1;
+        uint64_t overwritten = newHead > TIMELINE_RING_SIZE ? newHead - TIMELINE_RING_SIZE : 0;
+        if (overwritten > first)
+        {
+            events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(std::min(overwritten, head) - first));
+        }
+        return events;
+    }
+
+    void writeJsonString(std::ostream& stream, const char* text)
+    {
+        stream << '"';
+        for (; *text; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+            {
+                stream << '\\';
+            }
+            stream << *text;
+        }
+        stream << '"';
+    }
+}
+
+namespace ePugStation
+{
+    void setTimelineEnabled(bool isEnabled)
+    {
+        g_isEnabled.store(isEnabled, std::memory_order_relaxed);
+    }
+
+    bool isTimelineEnabled()
+    {
+        return g_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    int64_t getTimelineTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+    }
+
+    void recordTimelineEvent(const char* name, int64_t start, int64_t end)
+    {
+        Ring* ring = t_ring ? t_ring : registerThread();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        Event& event = ring->events[head & (TIMELINE_RING_SIZE - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void saveTimeline(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Could not create timeline : " + path);
+        }
+
+        // Complete events ("X"), timestamps in microseconds
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool isFirst = true;
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (const auto& ring : g_rings)
+        {
+            for (const EventCopy& event : copyEvents(*ring))
+            {
+                file << (isFirst ? "\n" : ",\n") << "{\"name\":";
+                writeJsonString(file, event.name);
+                file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadIndex
+                     << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                     << ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0 << "}";
+                isFirst = false;
+            }
+        }
+        file << "\n]}\n";
+    }
+}
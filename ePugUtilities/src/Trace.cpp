@@ -0,0 +1,279 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+    using namespace ePugStation;
+
+    constexpr uint8_t JUMP_FLAG = 0x80;
+    constexpr uint8_t WRITE_COUNT_MASK = 0x3f;
+
+    constexpr size_t KEY_FRAME_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + TRACE_REGISTER_COUNT * sizeof(uint32_t);
+    // Flags, PC delta, instruction, then index and delta of every register
+    constexpr size_t MAX_RECORD_SIZE = 1 + 5 + 4 + TRACE_REGISTER_COUNT * (1 + 5);
+
+    uint32_t zigzag(uint32_t delta)
+    {
+        return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+    }
+
+    uint32_t unzigzag(uint32_t value)
+    {
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+
+    // Writers advance "cursor", room was checked against MAX_RECORD_SIZE beforehand
+    void writeVarint(uint8_t*& cursor, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            *cursor++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *cursor++ = static_cast<uint8_t>(value);
+    }
+
+    template<typename T>
+    void writeRaw(uint8_t*& cursor, T value)
+    {
+        std::memcpy(cursor, &value, sizeof(T));
+        cursor += sizeof(T);
+    }
+
+    class ChunkReader
+    {
+    public:
+        ChunkReader(const uint8_t* data, size_t size) : m_data(data), m_end(data + size) {}
+
+        bool isAtEnd() const { return m_data == m_end; }
+
+        uint8_t readByte()
+        {
+            check(1);
+            return *m_data++;
+        }
+
+        uint32_t readVarint()
+        {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                uint8_t byte = readByte();
+                value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                {
+                    return value;
+                }
+            }
+            throw std::runtime_error("Invalid varint in trace");
+        }
+
+        template<typename T>
+        T readRaw()
+        {
+            T value;
+            std::memcpy(&value, view(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        const uint8_t* view(size_t size)
+        {
+            check(size);
+            const uint8_t* data = m_data;
+            m_data += size;
+            return data;
+        }
+
+    private:
+        void check(size_t size) const
+        {
+            if (size > static_cast<size_t>(m_end - m_data))
+            {
+                throw std::runtime_error("Trace truncated");
+            }
+        }
+
+        const uint8_t* m_data;
+        const uint8_t* m_end;
+    };
+}
+
+namespace ePugStation
+{
+    TraceRecorder::TraceRecorder(size_t capacity, size_t chunkSize)
+        : m_chunkSize(std::max(chunkSize, KEY_FRAME_SIZE + MAX_RECORD_SIZE)),
+          m_maxChunks(std::max<size_t>(capacity / m_chunkSize, 2))
+    {
+        startChunk();
+    }
+
+    void TraceRecorder::record(uint32_t pc, uint32_t instruction, const TraceRegisters& registers)
+    {
+        if (m_chunks.back().size + MAX_RECORD_SIZE > m_chunkSize)
+        {
+            startChunk();
+        }
+        Chunk& chunk = m_chunks.back();
+        uint8_t* flags = chunk.data.data() + chunk.size;
+        uint8_t* cursor = flags + 1;
+
+        *flags = 0;
+        if (pc != m_state.pc + 4)
+        {
+            *flags = JUMP_FLAG;
+            writeVarint(cursor, zigzag(pc - (m_state.pc + 4)));
+        }
+        writeRaw(cursor, instruction);
+
+        uint8_t writeCount = 0;
+        for (uint8_t index = 0; index < TRACE_REGISTER_COUNT; ++index)
+        {
+            if (registers[index] != m_state.registers[index])
+            {
+                *cursor++ = index;
+                writeVarint(cursor, zigzag(registers[index] - m_state.registers[index]));
+                ++writeCount;
+            }
+        }
+        *flags |= writeCount;
+        chunk.size = static_cast<size_t>(cursor - chunk.data.data());
+
+        m_state.pc = pc;
+        m_state.instruction = instruction;
+        m_state.registers = registers;
+        ++m_state.index;
+    }
+
+    void TraceRecorder::save(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not create trace : " + path);
+        }
+
+        uint32_t chunkCount = static_cast<uint32_t>(m_chunks.size());
+        file.write(reinterpret_cast<const char*>(&TRACE_MAGIC), sizeof(TRACE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&TRACE_VERSION), sizeof(TRACE_VERSION));
+        file.write(reinterpret_cast<const char*>(&chunkCount), sizeof(chunkCount));
+        for (const Chunk& chunk : m_chunks)
+        {
+            uint32_t size = static_cast<uint32_t>(chunk.size);
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(reinterpret_cast<const char*>(chunk.data.data()), chunk.size);
+        }
+    }
+
+    void TraceRecorder::startChunk()
+    {
+        if (m_chunks.size() == m_maxChunks)
+        {
+            // Reuse the oldest chunk allocation
+            m_chunks.push_back(std::move(m_chunks.front()));
+            m_chunks.pop_front();
+        }
+        else
+        {
+            m_chunks.emplace_back();
+            m_chunks.back().data.resize(m_chunkSize);
+        }
+
+        Chunk& chunk = m_chunks.back();
+        uint8_t* cursor = chunk.data.data();
+        writeRaw(cursor, m_state.index);
+        writeRaw(cursor, m_state.pc);
+        for (uint32_t value : m_state.registers)
+        {
+            writeRaw(cursor, value);
+        }
+        chunk.size = static_cast<size_t>(cursor - chunk.data.data());
+    }
+
+    std::vector<TraceEntry> readTrace(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Could not open trace : " + path);
+        }
+        std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        ChunkReader reader(buffer.data(), buffer.size());
+        if (reader.readRaw<uint32_t>() != TRACE_MAGIC)
+        {
+            throw std::runtime_error("Not a trace : " + path);
+        }
+        uint32_t version = reader.readRaw<uint32_t>();
+        if (version != TRACE_VERSION)
+        {
+            throw std::runtime_error("Unsupported trace version : " + std::to_string(version));
+        }
+
+        std::vector<TraceEntry> entries;
+        uint32_t chunkCount = reader.readRaw<uint32_t>();
+        for (uint32_t i = 0; i < chunkCount; ++i)
+        {
+            uint32_t size = reader.readRaw<uint32_t>();
+            ChunkReader chunk(reader.view(size), size);
+
+            TraceEntry state;
+            state.index = chunk.readRaw<uint64_t>();
+            state.pc = chunk.readRaw<uint32_t>();
+            for (uint32_t& value : state.registers)
+            {
+                value = chunk.readRaw<uint32_t>();
+            }
+
+            while (!chunk.isAtEnd())
+            {
+                uint8_t flags = chunk.readByte();
+                uint32_t pc = state.pc + 4;
+                if (flags & JUMP_FLAG)
+                {
+                    pc += unzigzag(chunk.readVarint());
+                }
+                state.pc = pc;
+                state.instruction = chunk.readRaw<uint32_t>();
+                for (uint8_t write = 0; write < (flags & WRITE_COUNT_MASK); ++write)
+                {
+                    uint8_t index = chunk.readByte();
+                    if (index >= TRACE_REGISTER_COUNT)
+                    {
+                        throw std::runtime_error("Invalid register in trace : " + std::to_string(index));
+                    }
+                    state.registers[index] += unzigzag(chunk.readVarint());
+                }
+                entries.push_back(state);
+                ++state.index;
+            }
+        }
+        return entries;
+    }
+
+    std::optional<size_t> findFirstDivergence(const std::vector<TraceEntry>& first, const std::vector<TraceEntry>& second)
+    {
+        if (first.empty() || second.empty())
+        {
+            return std::nullopt;
+        }
+
+        // Indices are contiguous inside a trace
+        uint64_t start = std::max(first.front().index, second.front().index);
+        uint64_t end = std::min(first.back().index, second.back().index) + 1;
+        for (uint64_t index = start; index < end; ++index)
+        {
+            const TraceEntry& a = first[index - first.front().index];
+            const TraceEntry& b = second[index - second.front().index];
+            if (a.pc != b.pc || a.instruction != b.instruction || a.registers != b.registers)
+            {
+                return static_cast<size_t>(index - first.front().index);
+            }
+        }
+        return std::nullopt;
+    }
+}
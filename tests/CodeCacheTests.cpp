@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include "BiosImage.h"
+#include "CodeCache.h"
+#include "CPU.h"
+#include "Interconnect.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+TEST_CASE("Opcodes are decoded from the primary, SPECIAL and REGIMM fields")
+{
+    using ePugStation::Opcode;
+    REQUIRE(ePugStation::decodeOpcode(0x3c088000) == Opcode::LUI);    // lui t0, 0x8000
+    REQUIRE(ePugStation::decodeOpcode(0xad090100) == Opcode::SW);     // sw t1, 0x100(t0)
+    REQUIRE(ePugStation::decodeOpcode(0x00000000) == Opcode::SLL);    // nop
+    REQUIRE(ePugStation::decodeOpcode(0x03e00008) == Opcode::JR);     // jr ra
+    REQUIRE(ePugStation::decodeOpcode(0x04110003) == Opcode::BGEZAL); // bgezal zero, 3
+    REQUIRE(ePugStation::decodeOpcode(0x4a000001) == Opcode::Cop2);   // GTE command
+    REQUIRE(ePugStation::decodeOpcode(0x0000003f) == Opcode::InvalidSubOp);
+    REQUIRE(ePugStation::decodeOpcode(0x04050000) == Opcode::InvalidBranchOp);
+    REQUIRE(ePugStation::decodeOpcode(0xfc000000) == Opcode::InvalidPrimary);
+}
+
+TEST_CASE("Decoded BIOS is shared by images with the same content")
+{
+    auto first = ePugStation::BiosImage::fromWords({ 0x3c088000, 0xad090100 });
+    auto second = ePugStation::BiosImage::fromWords({ 0x3c088000, 0xad090100 });
+    auto other = ePugStation::BiosImage::fromWords({ 0x3c088000 });
+    REQUIRE(first->getHash() == second->getHash());
+
+    auto decoded = ePugStation::getDecodedBios(*first);
+    REQUIRE(ePugStation::getDecodedBios(*second) == decoded);
+    REQUIRE(ePugStation::getDecodedBios(*other) != decoded);
+    REQUIRE(decoded->getOpcode(0) == ePugStation::Opcode::LUI);
+    REQUIRE(decoded->getOpcode(4) == ePugStation::Opcode::SW);
+    REQUIRE(decoded->size() == ePugStation::BIOS_MEMORY_SIZE);
+}
+
+TEST_CASE("Fetching from a patched BIOS decodes the patched words")
+{
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromWords({ 0x3c088000 }));
+    ePugStation::Opcode opcode;
+    REQUIRE(interconnect->fetch32(0xbfc00000, opcode) == 0x3c088000);
+    REQUIRE(opcode == ePugStation::Opcode::LUI);
+
+    interconnect->setBiosWritePolicy(ePugStation::BiosWritePolicy::CopyOnWrite);
+    interconnect->store32(0xbfc00000, 0xad090100);
+    REQUIRE(interconnect->fetch32(0xbfc00000, opcode) == 0xad090100);
+    REQUIRE(opcode == ePugStation::Opcode::SW);
+}
+
+TEST_CASE("Decoded code is saved and mapped back from disk")
+{
+    auto bios = ePugStation::BiosImage::fromWords({ 0x3c088000, 0xad090100, 0x03e00008 });
+    ePugStation::DecodedCode decoded(bios->data(), bios->size(), bios->getHash());
+    auto path = (std::filesystem::temp_directory_path() / "ePugStationCodeCache.epcc").string();
+    decoded.save(path);
+
+    SECTION("Loaded table matches the decoded one")
+    {
+        auto loaded = ePugStation::DecodedCode::load(path, bios->getHash(), bios->size());
+        REQUIRE(loaded);
+        REQUIRE(loaded->isMapped());
+        REQUIRE(loaded->size() == decoded.size());
+        for (uint32_t offset = 0; offset < decoded.size(); offset += 4)
+        {
+            REQUIRE(loaded->getOpcode(offset) == decoded.getOpcode(offset));
+        }
+    }
+
+    SECTION("Saving again replaces the file")
+    {
+        decoded.save(path);
+        REQUIRE(ePugStation::DecodedCode::load(path, bios->getHash(), bios->size()));
+    }
+
+    SECTION("Files saved for other content are ignored")
+    {
+        REQUIRE_FALSE(ePugStation::DecodedCode::load(path, bios->getHash() + 1, bios->size()));
+    }
+
+    SECTION("Damaged files are ignored")
+    {
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(-1, std::ios::end);
+            file.put(static_cast<char>(ePugStation::Opcode::LUI));
+        }
+        REQUIRE_FALSE(ePugStation::DecodedCode::load(path, bios->getHash(), bios->size()));
+    }
+
+    SECTION("Files of another version are ignored")
+    {
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(sizeof(uint32_t));
+            uint32_t version = ePugStation::CODE_CACHE_VERSION + 1;
+            file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        }
+        REQUIRE_FALSE(ePugStation::DecodedCode::load(path, bios->getHash(), bios->size()));
+    }
+
+    SECTION("Truncated files are ignored")
+    {
+        std::filesystem::resize_file(path, 16);
+        REQUIRE_FALSE(ePugStation::DecodedCode::load(path, bios->getHash(), bios->size()));
+    }
+
+    REQUIRE_FALSE(ePugStation::DecodedCode::load(path + ".missing", bios->getHash(), bios->size()));
+    std::filesystem::remove(path);
+}
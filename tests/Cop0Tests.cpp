@@ -0,0 +1,45 @@
+#include <catch2/catch.hpp>
+
+#include "Cop0.h"
+
+namespace
+{
+    constexpr uint32_t SR_IEC = 1 << 0;
+    constexpr uint32_t SR_KUC = 1 << 1;
+    constexpr uint32_t SR_IEP = 1 << 2;
+    constexpr uint32_t SR_KUP = 1 << 3;
+    constexpr uint32_t SR_IM2 = 1 << 10; // Interrupt controller line
+}
+
+TEST_CASE("Interrupt is pending when enabled and unmasked")
+{
+    ePugStation::Cop0 cop0;
+    cop0.setHardwareInterrupt(true);
+    CHECK_FALSE(cop0.isInterruptPending());
+
+    cop0.setSR(SR_IM2);
+    CHECK_FALSE(cop0.isInterruptPending());
+
+    cop0.setSR(SR_IM2 | SR_IEC);
+    CHECK(cop0.isInterruptPending());
+
+    cop0.setHardwareInterrupt(false);
+    CHECK_FALSE(cop0.isInterruptPending());
+}
+
+TEST_CASE("Exception entry disables interrupts until rfe")
+{
+    ePugStation::Cop0 cop0;
+    cop0.setSR(SR_IM2 | SR_IEC | SR_KUC);
+    cop0.setHardwareInterrupt(true);
+    REQUIRE(cop0.isInterruptPending());
+
+    // The handler runs in kernel mode, the pending interrupt must not re-enter it
+    cop0.updateOldInterupts();
+    CHECK(cop0.getSR() == (SR_IM2 | SR_IEP | SR_KUP));
+    CHECK_FALSE(cop0.isInterruptPending());
+
+    cop0.updateNewInterupts();
+    CHECK(cop0.getSR() == (SR_IM2 | SR_IEC | SR_KUC));
+    CHECK(cop0.isInterruptPending());
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include "DMA.h"
+
+namespace
+{
+    constexpr uint32_t FORCE_IRQ = 1 << 15;
+    constexpr uint32_t MASTER_ENABLE = 1 << 23;
+    constexpr uint32_t MASTER_FLAG = 1u << 31;
+
+    constexpr uint32_t enableBit(uint32_t channel) { return 1 << (16 + channel); }
+    constexpr uint32_t flagBit(uint32_t channel) { return 1 << (24 + channel); }
+}
+
+TEST_CASE("DICR flags are acknowledged by writing 1")
+{
+    ePugStation::DMA dma;
+    dma.setInterrupt(MASTER_ENABLE | enableBit(2) | enableBit(6));
+    dma.finalizeCopy(2);
+    dma.finalizeCopy(6);
+    REQUIRE((dma.getInterrupt() & (flagBit(2) | flagBit(6))) == (flagBit(2) | flagBit(6)));
+
+    SECTION("Writing 0 keeps the flags")
+    {
+        dma.setInterrupt(MASTER_ENABLE | enableBit(2) | enableBit(6));
+        CHECK((dma.getInterrupt() & (flagBit(2) | flagBit(6))) == (flagBit(2) | flagBit(6)));
+    }
+
+    SECTION("Writing 1 clears only that flag and keeps the R/W bits")
+    {
+        dma.setInterrupt(MASTER_ENABLE | enableBit(2) | enableBit(6) | flagBit(2));
+        CHECK((dma.getInterrupt() & flagBit(2)) == 0);
+        CHECK((dma.getInterrupt() & flagBit(6)) != 0);
+        CHECK((dma.getInterrupt() & 0x00ff803f) == (MASTER_ENABLE | enableBit(2) | enableBit(6)));
+    }
+
+    SECTION("The master flag cannot be written")
+    {
+        dma.setInterrupt(MASTER_ENABLE | enableBit(2) | enableBit(6) | flagBit(2) | flagBit(6) | MASTER_FLAG);
+        CHECK(dma.getInterrupt() == (MASTER_ENABLE | enableBit(2) | enableBit(6)));
+    }
+}
+
+TEST_CASE("DICR master flag")
+{
+    ePugStation::DMA dma;
+
+    SECTION("Force IRQ sets it regardless of the channels")
+    {
+        CHECK(dma.setInterrupt(FORCE_IRQ));
+        CHECK((dma.getInterrupt() & MASTER_FLAG) != 0);
+
+        dma.setInterrupt(0);
+        CHECK((dma.getInterrupt() & MASTER_FLAG) == 0);
+    }
+
+    SECTION("A channel flag needs its enable bit to raise a flag")
+    {
+        dma.setInterrupt(MASTER_ENABLE);
+        CHECK_FALSE(dma.finalizeCopy(3));
+        CHECK((dma.getInterrupt() & (flagBit(3) | MASTER_FLAG)) == 0);
+    }
+
+    SECTION("A channel flag needs the master enable to raise the master flag")
+    {
+        dma.setInterrupt(enableBit(3));
+        CHECK_FALSE(dma.finalizeCopy(3));
+        CHECK((dma.getInterrupt() & flagBit(3)) != 0);
+        CHECK((dma.getInterrupt() & MASTER_FLAG) == 0);
+
+        // Enabling the master afterwards raises it from the pending flag
+        CHECK(dma.setInterrupt(MASTER_ENABLE | enableBit(3)));
+        CHECK((dma.getInterrupt() & MASTER_FLAG) != 0);
+    }
+
+    SECTION("Acknowledging the last flag clears the master flag")
+    {
+        dma.setInterrupt(MASTER_ENABLE | enableBit(3));
+        CHECK(dma.finalizeCopy(3));
+        CHECK((dma.getInterrupt() & MASTER_FLAG) != 0);
+
+        dma.setInterrupt(MASTER_ENABLE | enableBit(3) | flagBit(3));
+        CHECK((dma.getInterrupt() & MASTER_FLAG) == 0);
+    }
+}
+
+TEST_CASE("DMA IRQ is raised only on the master flag 0 -> 1 edge")
+{
+    ePugStation::DMA dma;
+    dma.setInterrupt(MASTER_ENABLE | enableBit(0) | enableBit(1));
+
+    CHECK(dma.finalizeCopy(0));
+    // Master flag already set, no new edge
+    CHECK_FALSE(dma.finalizeCopy(1));
+    CHECK_FALSE(dma.finalizeCopy(0));
+    CHECK_FALSE(dma.setInterrupt(MASTER_ENABLE | enableBit(0) | enableBit(1) | FORCE_IRQ));
+
+    // Acknowledge everything, then the next transfer is a new edge
+    CHECK_FALSE(dma.setInterrupt(MASTER_ENABLE | enableBit(0) | enableBit(1) | flagBit(0) | flagBit(1)));
+    CHECK((dma.getInterrupt() & MASTER_FLAG) == 0);
+    CHECK(dma.finalizeCopy(1));
+}
+
+TEST_CASE("Finalizing a copy stops the channel")
+{
+    ePugStation::DMA dma;
+    // Enable + manual trigger
+    dma.setChannelControl(2, 0x11000000);
+    REQUIRE(dma.isChannelActive(2));
+
+    dma.finalizeCopy(2);
+    CHECK_FALSE(dma.isChannelActive(2));
+    CHECK(dma.getChannelControl(2) == 0);
+}
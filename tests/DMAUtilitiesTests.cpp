@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include "Constants.h"
+#include "DMAUtilities.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // Word by word OTC loop, as done by Interconnect::blockCopyDMA before the fast path
+    void referenceClearOrderingTable(std::vector<uint32_t>& ram, uint32_t address, uint32_t entries)
+    {
+        while (entries > 0)
+        {
+            uint32_t currentAddress = address & 0x1ffffc;
+            uint32_t srcWord = entries == 1 ? 0xffffff : ((address - 4) & 0x1ffffc);
+            ram[currentAddress >> 2] = srcWord;
+            address -= 4;
+            --entries;
+        }
+    }
+
+    void checkAgainstReference(uint32_t address, uint32_t entries)
+    {
+        std::vector<uint32_t> expected(ePugStation::RAM_SIZE / 4, 0xacacacac);
+        std::vector<uint32_t> actual(expected);
+
+        referenceClearOrderingTable(expected, address, entries);
+        ePugStation::clearOrderingTable(actual.data(), address, entries);
+
+        // Compare indices, stringifying 2 MB of RAM is too slow for the reporter
+        auto mismatch = std::mismatch(actual.begin(), actual.end(), expected.begin());
+        REQUIRE(std::distance(actual.begin(), mismatch.first) == std::distance(actual.begin(), actual.end()));
+    }
+}
+
+TEST_CASE("Ordering table clear matches word by word DMA")
+{
+    SECTION("Typical frame ordering table")
+    {
+        checkAgainstReference(0x000ffffc, 4096);
+    }
+    SECTION("Entry counts not multiple of vector width")
+    {
+        for (uint32_t entries = 1; entries < 20; ++entries)
+        {
+            checkAgainstReference(0x00001000 + (entries * 4), entries);
+        }
+    }
+    SECTION("Table reaching the start of RAM")
+    {
+        checkAgainstReference(0x0000003c, 16);
+    }
+    SECTION("Table wrapping under address 0")
+    {
+        checkAgainstReference(0x00000020, 64);
+    }
+    SECTION("Logical addresses are masked")
+    {
+        checkAgainstReference(0x801ffffe, 1000);
+    }
+    SECTION("Table longer than RAM")
+    {
+        checkAgainstReference(0x00000020, ePugStation::RAM_SIZE / 4);
+        checkAgainstReference(0x00000020, (ePugStation::RAM_SIZE / 4) * 2 + 5);
+        checkAgainstReference(0x001ffffc, (ePugStation::RAM_SIZE / 4) * 3 - 1);
+    }
+    SECTION("Empty transfer leaves RAM untouched")
+    {
+        checkAgainstReference(0x00010000, 0);
+    }
+}
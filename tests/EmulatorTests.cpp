@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "Emulator.h"
+#include "TestMachine.h"
+#include "ThreadPool.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using ePugStation::testing::COUNTER_PROGRAM;
+}
+
+TEST_CASE("Emulator instances share nothing but the BIOS")
+{
+    auto bios = ePugStation::BiosImage::fromWords(COUNTER_PROGRAM);
+    ePugStation::Emulator first(bios);
+    ePugStation::Emulator second(bios);
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        first.runFrame({}, 1000);
+    }
+    second.runFrame({}, 1000);
+
+    REQUIRE(first.getFrameCount() == 3);
+    REQUIRE(second.getFrameCount() == 1);
+    REQUIRE(first.getInterconnect().load32(0x80000100) != second.getInterconnect().load32(0x80000100));
+}
+
+TEST_CASE("Emulator instances give identical frames when run concurrently")
+{
+    auto bios = ePugStation::BiosImage::fromWords(COUNTER_PROGRAM);
+    ePugStation::Emulator reference(bios);
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        reference.runFrame({}, 5000);
+    }
+
+    std::vector<std::unique_ptr<ePugStation::Emulator>> emulators;
+    for (int instance = 0; instance < 8; ++instance)
+    {
+        emulators.push_back(std::make_unique<ePugStation::Emulator>(bios));
+    }
+    {
+        ePugStation::ThreadPool pool(4);
+        for (auto& emulator : emulators)
+        {
+            pool.submit([&emulator]
+            {
+                for (int frame = 0; frame < 20; ++frame)
+                {
+                    emulator->runFrame({}, 5000);
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    for (const auto& emulator : emulators)
+    {
+        REQUIRE(emulator->hashFrame() == reference.hashFrame());
+    }
+}
+
+TEST_CASE("Emulator state round trips")
+{
+    ePugStation::Emulator emulator(ePugStation::BiosImage::fromWords(COUNTER_PROGRAM));
+    emulator.runFrame({}, 1000);
+    std::vector<uint8_t> state;
+    emulator.saveState(state);
+    emulator.runFrame({}, 1000);
+    ePugStation::FrameHashes expected = emulator.hashFrame();
+
+    emulator.loadState(state.data(), state.size());
+    emulator.runFrame({}, 1000);
+    REQUIRE(emulator.hashFrame() == expected);
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include "FrameHash.h"
+#include "Hash.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+TEST_CASE("Hashes match the reference values")
+{
+    REQUIRE(ePugStation::hash64("", 0) == 0xef46db3751d8e999ULL);
+    REQUIRE(ePugStation::hash64("abc", 3) == 0x44bc2cf5ad770999ULL);
+
+    REQUIRE(ePugStation::crc32c("", 0) == 0u);
+    REQUIRE(ePugStation::crc32c("123456789", 9) == 0xe3069283u);
+}
+
+TEST_CASE("CRC32C chains over split buffers")
+{
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    uint32_t whole = ePugStation::crc32c(data.data(), data.size());
+    for (size_t split : { 0, 1, 7, 8, 333, 999 })
+    {
+        uint32_t first = ePugStation::crc32c(data.data(), split);
+        REQUIRE(ePugStation::crc32c(data.data() + split, data.size() - split, first) == whole);
+    }
+}
+
+TEST_CASE("Display area hash wraps around the VRAM edges")
+{
+    std::vector<uint16_t> vram(1024 * 512);
+    for (size_t i = 0; i < vram.size(); ++i)
+    {
+        vram[i] = static_cast<uint16_t>(i * 31);
+    }
+
+    ePugStation::DisplayArea area = { 1000, 510, 64, 4 };
+    std::vector<uint16_t> pixels;
+    for (uint32_t row = 0; row < area.height; ++row)
+    {
+        for (uint32_t column = 0; column < area.width; ++column)
+        {
+            pixels.push_back(vram[((area.y + row) % 512) * 1024 + (area.x + column) % 1024]);
+        }
+    }
+
+    REQUIRE(ePugStation::hashVramArea(vram.data(), area) == ePugStation::crc32c(pixels.data(), pixels.size() * sizeof(uint16_t)));
+
+    vram[1 * 1024 + 20] ^= 1; // Row 3, column 44 of the area
+    REQUIRE(ePugStation::hashVramArea(vram.data(), area) != ePugStation::crc32c(pixels.data(), pixels.size() * sizeof(uint16_t)));
+}
+
+TEST_CASE("Frame hash log round trips")
+{
+    std::vector<ePugStation::FrameHashes> frames = { { 1, 2, 3 }, { 4, 5, 6 }, { 0xffffffff, 0, 7 } };
+
+    auto path = std::filesystem::temp_directory_path() / "ePugStationFrameHashTest.log";
+    {
+        ePugStation::FrameHashLogWriter writer(path.string());
+        for (const auto& frame : frames)
+        {
+            writer.append(frame);
+        }
+    }
+    REQUIRE(std::filesystem::file_size(path) == 8 + frames.size() * 12);
+    REQUIRE((ePugStation::readFrameHashLog(path.string()) == frames));
+    std::filesystem::remove(path);
+}
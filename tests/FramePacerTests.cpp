@@ -0,0 +1,34 @@
+#include <catch2/catch.hpp>
+
+#include "FramePacer.h"
+
+TEST_CASE("Frame pacer holds frames to the refresh rate when throttled")
+{
+    ePugStation::FramePacer pacer(500.0, std::chrono::milliseconds(40));
+    auto start = ePugStation::FramePacer::Clock::now();
+    bool hasMeasured = false;
+    for (int frame = 0; frame < 25; ++frame)
+    {
+        hasMeasured |= pacer.endFrame();
+    }
+    auto elapsed = ePugStation::FramePacer::Clock::now() - start;
+
+    REQUIRE(elapsed >= std::chrono::milliseconds(48));
+    REQUIRE(hasMeasured);
+    REQUIRE(pacer.getSpeed() <= 1.05);
+    REQUIRE(pacer.getSpeed() > 0.0);
+}
+
+TEST_CASE("Frame pacer runs ahead of real time when unthrottled")
+{
+    ePugStation::FramePacer pacer(1.0, std::chrono::milliseconds(1));
+    pacer.setThrottled(false);
+    auto start = ePugStation::FramePacer::Clock::now();
+    while (!pacer.endFrame())
+    {
+    }
+
+    // One second of emulated time per frame
+    REQUIRE(ePugStation::FramePacer::Clock::now() - start < std::chrono::seconds(1));
+    REQUIRE(pacer.getSpeed() > 1.0);
+}
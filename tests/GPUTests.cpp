@@ -0,0 +1,45 @@
+#include <catch2/catch.hpp>
+
+#include "GPU.h"
+
+#include <memory>
+
+TEST_CASE("Headless GPU keeps VRAM in software")
+{
+    auto gpu = std::make_unique<ePugStation::GPU>();
+    REQUIRE(gpu->getVramData()[0] == 0);
+
+    // Copy rectangle from CPU to VRAM : 2x2 pixels at (16, 8)
+    gpu->setGP0Command(0xa0000000);
+    gpu->setGP0Command(0x00080010);
+    gpu->setGP0Command(0x00020002);
+    gpu->setGP0Command(0x22221111);
+    gpu->setGP0Command(0x44443333);
+
+    const uint16_t* vram = gpu->getVramData();
+    REQUIRE(vram[8 * 1024 + 16] == 0x1111);
+    REQUIRE(vram[8 * 1024 + 17] == 0x2222);
+    REQUIRE(vram[9 * 1024 + 16] == 0x3333);
+    REQUIRE(vram[9 * 1024 + 17] == 0x4444);
+    REQUIRE(gpu->getDirtyVramTiles().isDirty(ePugStation::DirtyTracker::SaveState, 0));
+}
+
+TEST_CASE("Every image load reaches VRAM")
+{
+    auto gpu = std::make_unique<ePugStation::GPU>();
+    for (uint32_t image = 0; image < 20; ++image)
+    {
+        // 2x1 pixels at (2 * image, 0)
+        gpu->setGP0Command(0xa0000000);
+        gpu->setGP0Command(2 * image);
+        gpu->setGP0Command(0x00010002);
+        gpu->setGP0Command(0x00010000 * (image + 1) + image + 1);
+    }
+
+    const uint16_t* vram = gpu->getVramData();
+    for (uint32_t image = 0; image < 20; ++image)
+    {
+        REQUIRE(vram[2 * image] == image + 1);
+        REQUIRE(vram[2 * image + 1] == image + 1);
+    }
+}
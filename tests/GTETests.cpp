@@ -0,0 +1,184 @@
+#include <catch2/catch.hpp>
+
+#include "GTE.h"
+
+namespace
+{
+    constexpr uint32_t SF = 1 << 19;
+
+    uint32_t command(ePugStation::GTEOp op, uint32_t flags = 0)
+    {
+        return 0x4a000000 | flags | static_cast<uint32_t>(op);
+    }
+
+    // Identity rotation, screen center at 160x120, H = 1000
+    void setupProjection(ePugStation::GTE& gte)
+    {
+        gte.setControl(0, 0x00001000); // RT11, RT12
+        gte.setControl(1, 0x00000000); // RT13, RT21
+        gte.setControl(2, 0x00001000); // RT22, RT23
+        gte.setControl(3, 0x00000000); // RT31, RT32
+        gte.setControl(4, 0x00001000); // RT33
+        gte.setControl(24, 160 << 16); // OFX
+        gte.setControl(25, 120 << 16); // OFY
+        gte.setControl(26, 1000);      // H
+    }
+}
+
+TEST_CASE("GTE RTPS projects a vertex")
+{
+    ePugStation::GTE gte;
+    setupProjection(gte);
+
+    gte.setData(0, (50 << 16) | 100); // VX0 = 100, VY0 = 50
+    gte.setData(1, 1000);             // VZ0 = 1000 = H, so no scaling
+    gte.execute(command(ePugStation::GTEOp::RTPS, SF));
+
+    REQUIRE(gte.getData(9) == 100);   // IR1
+    REQUIRE(gte.getData(10) == 50);   // IR2
+    REQUIRE(gte.getData(11) == 1000); // IR3
+    REQUIRE(gte.getData(19) == 1000); // SZ3
+    REQUIRE(gte.getData(14) == ((170u << 16) | 260u)); // SXY2
+    REQUIRE(gte.getControl(31) == 0);
+}
+
+TEST_CASE("GTE RTPS flags divide overflow")
+{
+    ePugStation::GTE gte;
+    setupProjection(gte);
+
+    gte.setData(0, (50 << 16) | 100);
+    gte.setData(1, 0);
+    gte.execute(command(ePugStation::GTEOp::RTPS, SF));
+
+    REQUIRE(gte.getData(14) == ((219u << 16) | 359u));
+    REQUIRE(gte.getControl(31) == ((1u << 31) | (1u << 17)));
+}
+
+TEST_CASE("GTE NCLIP and AVSZ3")
+{
+    ePugStation::GTE gte;
+
+    gte.setData(12, 0);
+    gte.setData(13, 10);
+    gte.setData(14, 10 << 16);
+    gte.execute(command(ePugStation::GTEOp::NCLIP));
+    REQUIRE(gte.getData(24) == 100);
+
+    gte.setControl(29, 0x555); // ZSF3 ~ 1/3
+    gte.setData(17, 100);
+    gte.setData(18, 200);
+    gte.setData(19, 300);
+    gte.execute(command(ePugStation::GTEOp::AVSZ3));
+    REQUIRE(gte.getData(24) == 819000);
+    REQUIRE(gte.getData(7) == 199);
+}
+
+TEST_CASE("GTE saturation flags")
+{
+    ePugStation::GTE gte;
+
+    SECTION("IR saturation sets the error bit")
+    {
+        gte.setData(9, 0x4000);
+        gte.execute(command(ePugStation::GTEOp::SQR, SF));
+        REQUIRE(gte.getData(25) == 0x10000);
+        REQUIRE(gte.getData(9) == 0x7fff);
+        REQUIRE(gte.getControl(31) == ((1u << 31) | (1u << 24)));
+    }
+    SECTION("Color FIFO saturation does not set the error bit")
+    {
+        gte.setData(6, 0x2c000000);
+        gte.setData(8, 0x800);
+        gte.setData(9, 0x1000);
+        gte.setData(10, 0x2000);
+        gte.setData(11, 0x3000);
+        gte.execute(command(ePugStation::GTEOp::GPF, SF));
+        REQUIRE(gte.getData(22) == 0x2cffff80);
+        REQUIRE(gte.getControl(31) == ((1u << 20) | (1u << 19)));
+    }
+}
+
+TEST_CASE("GTE register quirks")
+{
+    ePugStation::GTE gte;
+
+    SECTION("LZCR counts leading sign bits")
+    {
+        gte.setData(30, 0x00ffffff);
+        REQUIRE(gte.getData(31) == 8);
+        gte.setData(30, 0xff000000);
+        REQUIRE(gte.getData(31) == 8);
+        gte.setData(30, 0);
+        REQUIRE(gte.getData(31) == 32);
+        gte.setData(30, 0xffffffff);
+        REQUIRE(gte.getData(31) == 32);
+    }
+    SECTION("IRGB expands to IR and reads back as ORGB")
+    {
+        gte.setData(28, 0x7fff);
+        REQUIRE(gte.getData(9) == 0xf80);
+        REQUIRE(gte.getData(29) == 0x7fff);
+    }
+    SECTION("FLAG write mask and error bit")
+    {
+        gte.setControl(31, 0xffffffff);
+        REQUIRE(gte.getControl(31) == 0xfffff000);
+        gte.setControl(31, 1 << 22);
+        REQUIRE(gte.getControl(31) == (1u << 22));
+    }
+    SECTION("H reads back sign extended")
+    {
+        gte.setControl(26, 0x8000);
+        REQUIRE(gte.getControl(26) == 0xffff8000);
+    }
+    SECTION("SXYP pushes the screen FIFO")
+    {
+        gte.setData(14, 0x00020001);
+        gte.setData(15, 0x00040003);
+        REQUIRE(gte.getData(13) == 0x00020001);
+        REQUIRE(gte.getData(14) == 0x00040003);
+        REQUIRE(gte.getData(15) == 0x00040003);
+    }
+}
+
+TEST_CASE("GTE RTPT matches three RTPS")
+{
+    ePugStation::GTE batched;
+    ePugStation::GTE single;
+    for (ePugStation::GTE* gte : { &batched, &single })
+    {
+        setupProjection(*gte);
+        gte->setControl(0, 0x02001f00); // Some rotation on X/Y
+        gte->setControl(5, 0x20);       // TRX
+        gte->setControl(7, 0x400);      // TRZ
+        gte->setControl(27, 0x100);     // DQA
+        gte->setControl(28, 0x1000000); // DQB
+        gte->setData(0, 0xfff00030);
+        gte->setData(1, 0x600);
+        gte->setData(2, 0x00200010);
+        gte->setData(3, 0x800);
+        gte->setData(4, 0xffe0ffc0);
+        gte->setData(5, 0x700);
+    }
+
+    batched.execute(command(ePugStation::GTEOp::RTPT, SF));
+
+    // RTPS only transforms V0, copy V1 and V2 into it in turn
+    single.execute(command(ePugStation::GTEOp::RTPS, SF));
+    uint32_t flags = single.getControl(31);
+    for (uint32_t vertex = 1; vertex < 3; ++vertex)
+    {
+        single.setData(0, single.getData(vertex * 2));
+        single.setData(1, single.getData(vertex * 2 + 1));
+        single.execute(command(ePugStation::GTEOp::RTPS, SF));
+        flags |= single.getControl(31);
+    }
+
+    for (uint32_t reg = 6; reg < 32; ++reg)
+    {
+        INFO("Data register " << reg);
+        REQUIRE(batched.getData(reg) == single.getData(reg));
+    }
+    REQUIRE(batched.getControl(31) == flags);
+}
@@ -0,0 +1,210 @@
+#include <catch2/catch.hpp>
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "DMAPort.h"
+#include "Interconnect.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Produces 0x100, 0x101... and keeps what it consumes
+    class RecordingPort : public ePugStation::DMAPort
+    {
+    public:
+        void readWords(uint32_t* words, size_t count) override
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                words[i] = m_nextWord++;
+            }
+        }
+
+        void writeWords(const uint32_t* words, size_t count) override
+        {
+            received.insert(received.end(), words, words + count);
+        }
+
+        std::vector<uint32_t> received;
+
+    private:
+        uint32_t m_nextWord = 0x100;
+    };
+
+    // Manual sync, started right away, on the SPU channel
+    void startSpuTransfer(ePugStation::Interconnect& interconnect, uint32_t address, uint32_t words, bool isFromRam, bool isBackward)
+    {
+        interconnect.store32(0x1f8010c0, address);
+        interconnect.store32(0x1f8010c4, words);
+        interconnect.store32(0x1f8010c8, 0x11000000 | (isBackward ? 0x2 : 0) | (isFromRam ? 0x1 : 0));
+    }
+}
+
+TEST_CASE("Synthetic BIOS is mapped in KSEG0 and KSEG1")
+{
+    auto bios = ePugStation::BiosImage::fromWords({ 0x12345678, 0x9abcdef0 });
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(bios);
+
+    REQUIRE(interconnect->load32(0xbfc00000) == 0x12345678);
+    REQUIRE(interconnect->load32(0x9fc00004) == 0x9abcdef0);
+    REQUIRE(interconnect->load8(0xbfc00003) == 0x12);
+    REQUIRE(interconnect->load32(0xbfc00008) == 0);
+}
+
+TEST_CASE("BIOS stores are ignored")
+{
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromWords({ 0x1 }));
+    interconnect->store32(0xbfc00000, 0xdeadbeef);
+    interconnect->store16(0xbfc00000, 0xbeef);
+    interconnect->store8(0x9fc00000, 0xef);
+
+    REQUIRE(interconnect->load32(0xbfc00000) == 0x1);
+}
+
+TEST_CASE("BIOS stores go to a private overlay with copy on write")
+{
+    auto bios = ePugStation::BiosImage::fromWords({ 0x1, 0x2 });
+    auto patched = std::make_unique<ePugStation::Interconnect>(bios);
+    auto pristine = std::make_unique<ePugStation::Interconnect>(bios);
+    patched->setBiosWritePolicy(ePugStation::BiosWritePolicy::CopyOnWrite);
+    patched->store32(0xbfc00000, 0xdeadbeef);
+
+    REQUIRE(patched->load32(0xbfc00000) == 0xdeadbeef);
+    REQUIRE(patched->load32(0xbfc00004) == 0x2);
+    REQUIRE(pristine->load32(0xbfc00000) == 0x1);
+    REQUIRE(bios->data()[0] == 0x1);
+
+    SECTION("Byte and halfword stores")
+    {
+        patched->store16(0xbfc00006, 0xcafe);
+        patched->store8(0x9fc00004, 0x42);
+
+        REQUIRE(patched->load32(0xbfc00004) == 0xcafe0042);
+        REQUIRE(pristine->load32(0xbfc00004) == 0x2);
+    }
+}
+
+TEST_CASE("BIOS file is mapped")
+{
+    auto path = std::filesystem::temp_directory_path() / "ePugStationMappedBios.bin";
+    {
+        std::vector<uint32_t> rom(ePugStation::BIOS_MEMORY_SIZE / 4);
+        for (size_t i = 0; i < rom.size(); ++i)
+        {
+            rom[i] = static_cast<uint32_t>(i);
+        }
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(rom.data()), static_cast<std::streamsize>(ePugStation::BIOS_MEMORY_SIZE));
+    }
+
+    {
+        auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromFile(path.string()));
+        REQUIRE(interconnect->load32(0xbfc00010) == 4);
+        REQUIRE(interconnect->load32(0xbfc7fffc) == 0x1ffff);
+    }
+
+    std::filesystem::resize_file(path, 1024);
+    REQUIRE_THROWS(ePugStation::BiosImage::fromFile(path.string()));
+    std::filesystem::remove(path);
+    REQUIRE_THROWS(ePugStation::BiosImage::fromFile(path.string()));
+}
+
+TEST_CASE("BIOS image can be shared between interconnects")
+{
+    std::vector<uint8_t> rom(ePugStation::BIOS_MEMORY_SIZE, 0x5a);
+    auto bios = ePugStation::BiosImage::fromMemory(rom.data(), rom.size());
+    auto first = std::make_unique<ePugStation::Interconnect>(bios);
+    auto second = std::make_unique<ePugStation::Interconnect>(bios);
+
+    REQUIRE(first->load32(0xbfc7fffc) == 0x5a5a5a5a);
+    REQUIRE(second->load32(0xbfc7fffc) == 0x5a5a5a5a);
+    REQUIRE_THROWS(ePugStation::BiosImage::fromMemory(rom.data(), rom.size() - 4));
+}
+
+TEST_CASE("Headless interconnect reports a ready GPU")
+{
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromWords({}));
+    interconnect->store32(0x1f801810, 0xe1000000); // GP0 dropped
+
+    REQUIRE((interconnect->load32(0x1f801814) & 0x1c000000) == 0x1c000000);
+}
+
+TEST_CASE("CPU runs a synthetic BIOS")
+{
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromWords({
+        0x3c088000, // lui t0, 0x8000
+        0x2409002a, // addiu t1, zero, 42
+        0xad090100, // sw t1, 0x100(t0)
+        0x00000000  // nop
+    }));
+    ePugStation::CPU cpu(interconnect.get());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        cpu.runNextInstruction();
+    }
+
+    REQUIRE(interconnect->load32(0x80000100) == 42);
+}
+
+TEST_CASE("DMA transfers reach the port plugged on their channel")
+{
+    auto interconnect = std::make_unique<ePugStation::Interconnect>(ePugStation::BiosImage::fromWords({}));
+    RecordingPort port;
+    interconnect->setDMAPort(ePugStation::DMAChannelPort::SPU, &port);
+
+    SECTION("RAM to device, forward and backward")
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            interconnect->store32(0x1000 + i * 4, 0xa0 + i);
+        }
+        startSpuTransfer(*interconnect, 0x1000, 4, true, false);
+        startSpuTransfer(*interconnect, 0x100c, 4, true, true);
+        REQUIRE((port.received == std::vector<uint32_t>{ 0xa0, 0xa1, 0xa2, 0xa3, 0xa3, 0xa2, 0xa1, 0xa0 }));
+    }
+
+    SECTION("Device to RAM, forward and backward")
+    {
+        startSpuTransfer(*interconnect, 0x2000, 2, false, false);
+        startSpuTransfer(*interconnect, 0x2104, 2, false, true);
+        REQUIRE(interconnect->load32(0x2000) == 0x100);
+        REQUIRE(interconnect->load32(0x2004) == 0x101);
+        REQUIRE(interconnect->load32(0x2104) == 0x102);
+        REQUIRE(interconnect->load32(0x2100) == 0x103);
+    }
+
+    SECTION("Transfers crossing the end of RAM wrap")
+    {
+        startSpuTransfer(*interconnect, 0x1ffffc, 2, false, false);
+        REQUIRE(interconnect->load32(0x1ffffc) == 0x100);
+        REQUIRE(interconnect->load32(0x0) == 0x101);
+    }
+
+    SECTION("Transfers larger than RAM are truncated to one lap")
+    {
+        // Sync mode 1, 17173 blocks of 62525 words overflow a 32-bit byte count
+        interconnect->store32(0x1f8010c0, 0x100);
+        interconnect->store32(0x1f8010c4, (17173 << 16) | 62525);
+        interconnect->store32(0x1f8010c8, 0x01000201);
+        REQUIRE(port.received.size() == ePugStation::RAM_SIZE / 4);
+
+        interconnect->store32(0x1f8010c0, 0x100);
+        interconnect->store32(0x1f8010c4, (17173 << 16) | 62525);
+        interconnect->store32(0x1f8010c8, 0x01000200);
+        REQUIRE(interconnect->load32(0x100) == 0x100);
+        REQUIRE(interconnect->load32(0xfc) == 0x100 + ePugStation::RAM_SIZE / 4 - 1);
+    }
+
+    SECTION("Other channels do not reach the port")
+    {
+        interconnect->store32(0x1f8010a0, 0x1000);
+        interconnect->store32(0x1f8010a4, 1);
+        interconnect->store32(0x1f8010a8, 0x11000001);
+        REQUIRE(port.received.empty());
+    }
+}
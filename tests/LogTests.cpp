@@ -0,0 +1,85 @@
+#include <catch2/catch.hpp>
+
+#include "Logger.h"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Collects the messages reaching the sink, restores the default one when destroyed
+    class CapturingSink
+    {
+    public:
+        CapturingSink()
+        {
+            ePugStation::setLogSink([this](ePugStation::LogLevel, ePugStation::LogSubsystem, const char* message)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_messages.emplace_back(message);
+            });
+        }
+
+        ~CapturingSink() { ePugStation::setLogSink(nullptr); }
+
+        std::vector<std::string> getMessages()
+        {
+            ePugStation::flushLog();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_messages;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::string> m_messages;
+    };
+}
+
+TEST_CASE("Log call sites are rate limited")
+{
+    CapturingSink sink;
+    for (int i = 0; i < 100; ++i)
+    {
+        E_PUG_STATION_LOG(Warning, Memory, "Unhandled store %d", i);
+    }
+
+    auto messages = sink.getMessages();
+    // Nothing past the burst within the same second
+    REQUIRE(messages.size() == ePugStation::LOG_BURST);
+    REQUIRE(messages[0] == "Unhandled store 0");
+    REQUIRE(messages[4] == "Unhandled store 4");
+}
+
+TEST_CASE("Log levels filter per subsystem")
+{
+    CapturingSink sink;
+    ePugStation::setLogLevel(ePugStation::LogSubsystem::GPU, ePugStation::LogLevel::Error);
+    E_PUG_STATION_LOG(Warning, GPU, "filtered");
+    E_PUG_STATION_LOG(Warning, CPU, "kept");
+    E_PUG_STATION_LOG(Error, GPU, "error");
+    ePugStation::setLogLevel(ePugStation::LogSubsystem::GPU, ePugStation::LogLevel::Info);
+
+    auto messages = sink.getMessages();
+    REQUIRE((messages == std::vector<std::string>{ "kept", "error" }));
+}
+
+TEST_CASE("Log accepts messages from many threads")
+{
+    CapturingSink sink;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread)
+    {
+        threads.emplace_back([thread] {
+            E_PUG_STATION_LOG(Error, Frontend, "thread %d", thread);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto messages = sink.getMessages();
+    REQUIRE(messages.size() == 4);
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch.hpp>
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Input.h"
+#include "Interconnect.h"
+#include "Metrics.h"
+#include "Replay.h"
+#include "TestMachine.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    using ePugStation::testing::COUNTER_PROGRAM;
+}
+
+TEST_CASE("Metrics count instructions and memory accesses")
+{
+    auto before = ePugStation::getMetrics();
+
+    ePugStation::Interconnect interconnect(ePugStation::BiosImage::fromWords(COUNTER_PROGRAM));
+    ePugStation::CPU cpu(&interconnect);
+    ePugStation::runFrame(cpu, interconnect, ePugStation::FrameInput{}, 402);
+
+    auto after = ePugStation::getMetrics();
+    REQUIRE(after.get(ePugStation::Metric::Instructions) - before.get(ePugStation::Metric::Instructions) == 402);
+    // Every fetch reads the BIOS, the loop stores once every 4 instructions
+    REQUIRE(after.get(ePugStation::Metric::BiosAccesses) - before.get(ePugStation::Metric::BiosAccesses) == 402);
+    REQUIRE(after.get(ePugStation::Metric::RamAccesses) - before.get(ePugStation::Metric::RamAccesses) == 100);
+}
+
+TEST_CASE("Metrics keep the counts of exited threads")
+{
+    auto before = ePugStation::getMetrics();
+    std::thread thread([] {
+        ePugStation::countDmaWords(2, 10);
+        ePugStation::countGp0Command(0x28);
+    });
+    thread.join();
+    ePugStation::countDmaWords(2, 5);
+
+    auto after = ePugStation::getMetrics();
+    REQUIRE(after.getDmaWords(2) - before.getDmaWords(2) == 15);
+    REQUIRE(after.getGp0Commands(0x28) - before.getGp0Commands(0x28) == 1);
+
+    std::ostringstream prometheus;
+    after.writePrometheus(prometheus);
+    REQUIRE(prometheus.str().find("# TYPE epugstation_dma_words_total counter\n") != std::string::npos);
+    REQUIRE(prometheus.str().find("epugstation_dma_words_total{channel=\"2\"} " + std::to_string(after.getDmaWords(2)) + "\n") != std::string::npos);
+    REQUIRE(prometheus.str().find("epugstation_gp0_commands_total{opcode=\"0x28\"} ") != std::string::npos);
+    REQUIRE(prometheus.str().find("epugstation_memory_accesses_total{region=\"ram\"} ") != std::string::npos);
+
+    std::ostringstream text;
+    after.writeText(text);
+    REQUIRE(text.str().find("DMA words, channel 2") != std::string::npos);
+}
+
+TEST_CASE("Metrics file is replaced on every save")
+{
+    auto path = (std::filesystem::temp_directory_path() / "ePugStationMetricsTest.prom").string();
+    ePugStation::saveMetricsPrometheus(path);
+    ePugStation::countMetric(ePugStation::Metric::DrawCalls);
+    ePugStation::saveMetricsPrometheus(path);
+
+    std::ifstream file(path);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    REQUIRE(content.find("epugstation_draw_calls_total") != std::string::npos);
+    REQUIRE_FALSE(std::filesystem::exists(path + ".tmp"));
+    file.close();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch.hpp>
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "Profiler.h"
+#include "Trace.h"
+
+#include <sstream>
+
+namespace
+{
+    // Calls a function counting down t1 from 100, forever
+    const std::vector<uint32_t> CALL_PROGRAM = {
+        0x0ff00006, // main: jal count (0xbfc00018)
+        0x00000000, // nop
+        0x0bf00000, // j main (0xbfc00000)
+        0x00000000, // nop
+        0x00000000, // nop
+        0x00000000, // nop
+        0x24090064, // count: addiu t1, zero, 100
+        0x2529ffff, // loop: addiu t1, t1, -1
+        0x1520fffe, // bne t1, zero, loop
+        0x00000000, // nop
+        0x03e00008, // jr ra
+        0x00000000  // nop
+    };
+
+    // Enables the VBlank interrupt and calls an empty function forever, the handler acknowledges
+    // the interrupt and returns to EPC
+    std::vector<uint32_t> makeInterruptedCallProgram()
+    {
+        std::vector<uint32_t> program = {
+            0x3c081f80, // lui t0, 0x1f80
+            0x34090001, // ori t1, zero, 1
+            0xad091074, // sw t1, 0x1074(t0) : I_MASK = VBlank
+            0x3c090040, // lui t1, 0x0040
+            0x35290401, // ori t1, t1, 0x0401
+            0x40896000, // mtc0 t1, SR : BEV, IM2, IEc
+            0x0ff0000c, // main: jal function (0xbfc00030)
+            0x00000000, // nop
+            0x0bf00006, // j main (0xbfc00018)
+            0x00000000, // nop
+            0x00000000, // nop
+            0x00000000, // nop
+            0x03e00008, // function: jr ra
+            0x00000000  // nop
+        };
+        program.resize(0x180 / 4);
+        program.insert(program.end(), {
+            0xad001070, // handler: sw zero, 0x1070(t0) : acknowledge I_STAT
+            0x401a7000, // mfc0 k0, EPC
+            0x00000000, // nop
+            0x03400008, // jr k0
+            0x42000010  // rfe
+        });
+        return program;
+    }
+
+    void runProfiled(ePugStation::Profiler& profiler, int instructions)
+    {
+        ePugStation::Interconnect interconnect(ePugStation::BiosImage::fromWords(CALL_PROGRAM));
+        ePugStation::CPU cpu(&interconnect);
+        for (int i = 0; i < instructions; ++i)
+        {
+            cpu.runNextInstruction<false, true>(nullptr, &profiler);
+        }
+    }
+}
+
+TEST_CASE("Profiler attributes samples to functions and basic blocks")
+{
+    ePugStation::ProfilerConfig config;
+    config.sampleInterval = 1;
+    ePugStation::Profiler profiler(config);
+    runProfiled(profiler, 10000);
+
+    REQUIRE(profiler.getSampleCount() == 10000);
+    REQUIRE(profiler.getStackDepth() <= 1);
+
+    auto functions = profiler.getFunctions();
+    REQUIRE(functions.size() == 2);
+    REQUIRE(functions[0].address == 0xbfc00018);
+    REQUIRE(functions[1].address == 0); // Main loop, outside of any call
+    REQUIRE(functions[0].samples > 9 * functions[1].samples);
+
+    auto blocks = profiler.getBlocks();
+    REQUIRE(blocks[0].address == 0xbfc0001c);
+
+    std::ostringstream folded;
+    profiler.writeFoldedStacks(folded);
+    REQUIRE(folded.str().find("root;0xbfc00018 " + std::to_string(functions[0].samples) + "\n") != std::string::npos);
+
+    std::ostringstream report;
+    profiler.writeReport(report);
+    REQUIRE(report.str().find("0xbfc0001c") != std::string::npos);
+}
+
+TEST_CASE("Profiler samples every interval")
+{
+    ePugStation::ProfilerConfig config;
+    config.sampleInterval = 100;
+    ePugStation::Profiler profiler(config);
+    runProfiled(profiler, 10050);
+    REQUIRE(profiler.getSampleCount() == 100);
+}
+
+TEST_CASE("Instructions stopped by an interrupt are neither profiled nor traced")
+{
+    constexpr uint32_t JAL_ADDRESS = 0xbfc00018;
+    ePugStation::ProfilerConfig config;
+    config.sampleInterval = 1;
+    ePugStation::Profiler profiler(config);
+    ePugStation::TraceRecorder trace;
+    ePugStation::Interconnect interconnect(ePugStation::BiosImage::fromWords(makeInterruptedCallProgram()));
+    ePugStation::CPU cpu(&interconnect);
+
+    uint64_t jalCount = 0;
+    for (int call = 0; call < 10; ++call)
+    {
+        while (cpu.getIp() != JAL_ADDRESS)
+        {
+            cpu.runNextInstruction<true, true>(&trace, &profiler);
+        }
+        // Taken on the jal, which runs again after the 5 handler instructions
+        interconnect.requestVBlank();
+        for (int i = 0; i < 7; ++i)
+        {
+            uint64_t records = trace.getRecordCount();
+            bool isJal = cpu.getIp() == JAL_ADDRESS;
+            cpu.runNextInstruction<true, true>(&trace, &profiler);
+            jalCount += isJal && trace.getRecordCount() > records;
+        }
+    }
+
+    REQUIRE(jalCount == 10);
+    REQUIRE(profiler.getStackDepth() <= 1);
+}
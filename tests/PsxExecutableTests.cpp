@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+
+#include "Emulator.h"
+#include "PsxExecutable.h"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t TEXT_ADDRESS = 0x80010000;
+    constexpr uint32_t BSS_ADDRESS = 0x80020000;
+    constexpr uint32_t GLOBAL_POINTER = 0x80028000;
+    constexpr uint32_t STACK_POINTER = 0x801fff00;
+
+    // Copies a bss word next to it, then a constant, and spins
+    const std::vector<uint32_t> TEXT = {
+        0x3c088002, // lui t0, 0x8002
+        0x8d090000, // lw t1, 0(t0)
+        0x00000000, // nop
+        0xad090004, // sw t1, 4(t0)
+        0x340a1234, // ori t2, zero, 0x1234
+        0xad0a0008, // sw t2, 8(t0)
+        0x08004006, // loop: j loop (0x80010018)
+        0x00000000  // nop
+    };
+
+    std::vector<uint8_t> makeExecutable(uint32_t textAddress = TEXT_ADDRESS, uint32_t stackBase = STACK_POINTER - 0x100)
+    {
+        std::vector<uint8_t> file(ePugStation::PSX_EXE_HEADER_SIZE + TEXT.size() * sizeof(uint32_t));
+        std::memcpy(file.data(), "PS-X EXE", 8);
+        auto writeWord = [&file](size_t offset, uint32_t value) { std::memcpy(file.data() + offset, &value, sizeof(value)); };
+        writeWord(0x10, textAddress);
+        writeWord(0x14, GLOBAL_POINTER);
+        writeWord(0x18, textAddress);
+        writeWord(0x1c, static_cast<uint32_t>(TEXT.size() * sizeof(uint32_t)));
+        writeWord(0x28, BSS_ADDRESS);
+        writeWord(0x2c, 0x100);
+        writeWord(0x30, stackBase);
+        writeWord(0x34, 0x100);
+        std::memcpy(file.data() + ePugStation::PSX_EXE_HEADER_SIZE, TEXT.data(), TEXT.size() * sizeof(uint32_t));
+        return file;
+    }
+
+    void requireExecutableRan(ePugStation::Emulator& emulator)
+    {
+        const ePugStation::Interconnect& interconnect = emulator.getInterconnect();
+        REQUIRE(interconnect.load32(BSS_ADDRESS + 4) == 0);
+        REQUIRE(interconnect.load32(BSS_ADDRESS + 8) == 0x1234);
+        REQUIRE(emulator.getCPU().getRegister(28) == GLOBAL_POINTER);
+        REQUIRE(emulator.getCPU().getRegister(29) == STACK_POINTER);
+    }
+}
+
+TEST_CASE("PS-X EXE headers are parsed")
+{
+    std::vector<uint8_t> file = makeExecutable();
+    auto executable = ePugStation::PsxExecutable::fromMemory(file.data(), file.size());
+    REQUIRE(executable->getEntryPoint() == TEXT_ADDRESS);
+    REQUIRE(executable->getGlobalPointer() == GLOBAL_POINTER);
+    REQUIRE(executable->getTextAddress() == TEXT_ADDRESS);
+    REQUIRE(executable->getText().size() == TEXT.size() * sizeof(uint32_t));
+    REQUIRE(executable->getBssAddress() == BSS_ADDRESS);
+    REQUIRE(executable->getBssSize() == 0x100);
+    REQUIRE(executable->getStackPointer() == STACK_POINTER);
+}
+
+TEST_CASE("PS-X EXE without a stack base gets the default stack")
+{
+    std::vector<uint8_t> file = makeExecutable(TEXT_ADDRESS, 0);
+    auto executable = ePugStation::PsxExecutable::fromMemory(file.data(), file.size());
+    REQUIRE(executable->getStackPointer() == ePugStation::PSX_EXE_DEFAULT_STACK);
+
+    ePugStation::Emulator emulator(ePugStation::BiosImage::fromWords({ 0x0bf00000, 0x00000000 }));
+    emulator.loadExecutable(*executable);
+    REQUIRE(emulator.getCPU().getRegister(29) == ePugStation::PSX_EXE_DEFAULT_STACK);
+    REQUIRE(emulator.getCPU().getRegister(30) == ePugStation::PSX_EXE_DEFAULT_STACK);
+}
+
+TEST_CASE("Invalid PS-X EXE files are rejected")
+{
+    std::vector<uint8_t> file = makeExecutable();
+
+    SECTION("Wrong magic")
+    {
+        file[0] = 'X';
+        REQUIRE_THROWS_AS(ePugStation::PsxExecutable::fromMemory(file.data(), file.size()), std::runtime_error);
+    }
+
+    SECTION("Truncated text")
+    {
+        REQUIRE_THROWS_AS(ePugStation::PsxExecutable::fromMemory(file.data(), file.size() - 4), std::runtime_error);
+    }
+
+    SECTION("Text past the end of RAM")
+    {
+        file = makeExecutable(0x801ffff0);
+        REQUIRE_THROWS_AS(ePugStation::PsxExecutable::fromMemory(file.data(), file.size()), std::runtime_error);
+    }
+}
+
+TEST_CASE("PS-X EXE runs straight from its entry point")
+{
+    std::vector<uint8_t> file = makeExecutable();
+    auto executable = ePugStation::PsxExecutable::fromMemory(file.data(), file.size());
+    // The BIOS is never run
+    ePugStation::Emulator emulator(ePugStation::BiosImage::fromWords({ 0x0bf00000, 0x00000000 }));
+    emulator.loadExecutable(*executable);
+    REQUIRE(emulator.getCPU().getIp() == TEXT_ADDRESS);
+
+    emulator.runFrame({}, 100);
+    requireExecutableRan(emulator);
+}
+
+TEST_CASE("PS-X EXE is loaded when the BIOS jumps to the shell")
+{
+    std::vector<uint8_t> file = makeExecutable();
+    auto executable = ePugStation::PsxExecutable::fromMemory(file.data(), file.size());
+
+    SECTION("Loaded on the jump")
+    {
+        ePugStation::Emulator emulator(ePugStation::BiosImage::fromWords({
+            0x3c088003, // lui t0, 0x8003
+            0x01000008, // jr t0
+            0x00000000  // nop
+        }));
+        emulator.loadExecutableAfterBoot(executable);
+        emulator.runFrame({}, 100);
+        REQUIRE_FALSE(emulator.isExecutablePending());
+        requireExecutableRan(emulator);
+    }
+
+    SECTION("Pending as long as the BIOS does not reach the shell")
+    {
+        ePugStation::Emulator emulator(ePugStation::BiosImage::fromWords({ 0x0bf00000, 0x00000000 })); // j 0xbfc00000
+        emulator.loadExecutableAfterBoot(executable);
+        emulator.runFrame({}, 100);
+        REQUIRE(emulator.isExecutablePending());
+        REQUIRE(emulator.getInterconnect().load32(TEXT_ADDRESS) != TEXT[0]);
+    }
+}
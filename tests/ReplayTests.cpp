@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+
+#include "Replay.h"
+#include "TestMachine.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace
+{
+    using ePugStation::testing::Machine;
+
+    ePugStation::Replay record(uint32_t frameCount)
+    {
+        Machine machine;
+        ePugStation::ReplayRecorder recorder(*machine.cpu, *machine.interconnect, 1000);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            ePugStation::FrameInput input;
+            input.padButtons = frame % 2 ? ePugStation::PAD_CROSS : 0;
+            recorder.runFrame(*machine.cpu, *machine.interconnect, input);
+        }
+        return recorder.getReplay();
+    }
+}
+
+TEST_CASE("Replay reruns a recording bit for bit")
+{
+    auto replay = record(10);
+    REQUIRE(replay.hashes.front() != replay.hashes.back());
+
+    auto path = std::filesystem::temp_directory_path() / "ePugStationReplayTest.eprp";
+    replay.save(path.string());
+    auto loaded = ePugStation::Replay::load(path.string());
+    std::filesystem::remove(path);
+
+    Machine machine;
+    std::vector<ePugStation::FrameHashes> hashes;
+    auto result = ePugStation::runReplay(loaded, *machine.cpu, *machine.interconnect, [&](uint32_t, const ePugStation::FrameHashes& frameHashes)
+    {
+        hashes.push_back(frameHashes);
+    });
+
+    REQUIRE(result.frameCount == 10);
+    REQUIRE_FALSE(result.firstMismatch);
+    REQUIRE((hashes == replay.hashes));
+    REQUIRE(loaded.inputs[3].padButtons == ePugStation::PAD_CROSS);
+}
+
+TEST_CASE("Replay reports the first diverging frame")
+{
+    auto replay = record(6);
+    replay.hashes[4].ram ^= 1;
+    replay.hashes[5].ram ^= 1;
+
+    Machine machine;
+    auto result = ePugStation::runReplay(replay, *machine.cpu, *machine.interconnect);
+    REQUIRE(result.frameCount == 6);
+    REQUIRE(result.firstMismatch == 4u);
+}
+
+TEST_CASE("Replay with a corrupted size is refused before allocating")
+{
+    auto path = std::filesystem::temp_directory_path() / "ePugStationCorruptedReplayTest.eprp";
+    auto writeHeader = [&](uint32_t snapshotSize)
+    {
+        std::ofstream file(path, std::ios::binary);
+        const uint32_t header[] = { ePugStation::REPLAY_MAGIC, ePugStation::REPLAY_VERSION, 1000, snapshotSize };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        return file;
+    };
+
+    SECTION("Huge snapshot size")
+    {
+        writeHeader(0xffffffff).close();
+        REQUIRE_THROWS_WITH(ePugStation::Replay::load(path.string()), Catch::Contains("snapshot truncated"));
+    }
+
+    SECTION("Huge frame count")
+    {
+        auto file = writeHeader(0);
+        const uint32_t frameCount = 0x10000000;
+        file.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+        file.close();
+        REQUIRE_THROWS_WITH(ePugStation::Replay::load(path.string()), Catch::Contains("frames truncated"));
+    }
+
+    SECTION("Truncated recording")
+    {
+        auto replay = record(4);
+        replay.save(path.string());
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        REQUIRE_THROWS_WITH(ePugStation::Replay::load(path.string()), Catch::Contains("frames truncated"));
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,154 @@
+#include <catch2/catch.hpp>
+
+#include "RewindBuffer.h"
+#include "SaveState.h"
+#include "TestMachine.h"
+
+#include <memory>
+
+namespace
+{
+    // A few hundred instructions and a store to a different RAM page every frame
+    struct Machine : ePugStation::testing::Machine
+    {
+        void runFrame(uint32_t frame)
+        {
+            run(300);
+            interconnect->store32(0x80010000 + (frame % 8) * 0x1000, frame);
+        }
+    };
+}
+
+TEST_CASE("Rewind walks back through every captured frame")
+{
+    Machine machine;
+    ePugStation::RewindBuffer rewindBuffer(*machine.cpu, *machine.interconnect);
+
+    std::vector<std::vector<uint8_t>> states = { machine.save() };
+    for (uint32_t frame = 1; frame <= 12; ++frame)
+    {
+        machine.runFrame(frame);
+        rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        states.push_back(machine.save());
+    }
+
+    // Frames after the last capture are dropped by the first rewind
+    machine.runFrame(13);
+
+    for (auto state = states.rbegin(); state != states.rend(); ++state)
+    {
+        REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+        REQUIRE((machine.save() == *state));
+    }
+    REQUIRE_FALSE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+}
+
+TEST_CASE("Emulation resumes after a rewind and can be rewound again")
+{
+    Machine machine;
+    ePugStation::RewindBuffer rewindBuffer(*machine.cpu, *machine.interconnect);
+    std::vector<std::vector<uint8_t>> states = { machine.save() };
+    for (uint32_t frame = 1; frame <= 4; ++frame)
+    {
+        machine.runFrame(frame);
+        rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        states.push_back(machine.save());
+    }
+
+    // Restored snapshots are consumed, the next rewind goes further back
+    REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    REQUIRE((machine.save() == states[3]));
+
+    machine.runFrame(20);
+    rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+    auto frame20 = machine.save();
+    machine.runFrame(21);
+
+    REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    REQUIRE((machine.save() == frame20));
+    REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    REQUIRE((machine.save() == states[2]));
+}
+
+TEST_CASE("Save states taken or loaded during a rewind session are seen by the rewind buffer")
+{
+    Machine machine;
+    ePugStation::RewindBuffer rewindBuffer(*machine.cpu, *machine.interconnect);
+    std::vector<std::vector<uint8_t>> states = { machine.save() };
+
+    SECTION("Saved between captures")
+    {
+        for (uint32_t frame = 1; frame <= 6; ++frame)
+        {
+            machine.runFrame(frame);
+            if (frame % 2 == 0)
+            {
+                machine.save();
+            }
+            rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+            states.push_back(machine.save());
+        }
+    }
+
+    SECTION("Loaded between captures")
+    {
+        machine.runFrame(1);
+        rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        states.push_back(machine.save());
+        machine.runFrame(2);
+        ePugStation::loadState(*machine.cpu, *machine.interconnect, states[0].data(), states[0].size());
+        machine.runFrame(3);
+        rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        states.push_back(machine.save());
+    }
+
+    machine.runFrame(10);
+    for (auto state = states.rbegin(); state != states.rend(); ++state)
+    {
+        REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+        REQUIRE((machine.save() == *state));
+    }
+}
+
+TEST_CASE("Rewind buffer captures every interval and keeps within its budget")
+{
+    SECTION("Capture interval")
+    {
+        Machine machine;
+        ePugStation::RewindConfig config;
+        config.captureInterval = 3;
+        ePugStation::RewindBuffer rewindBuffer(*machine.cpu, *machine.interconnect, config);
+        for (uint32_t frame = 1; frame <= 9; ++frame)
+        {
+            machine.runFrame(frame);
+            rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        }
+
+        // Baseline and frames 3, 6 and 9
+        for (int i = 0; i < 4; ++i)
+        {
+            REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+        }
+        REQUIRE_FALSE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    }
+
+    SECTION("Memory budget")
+    {
+        Machine machine;
+        ePugStation::RewindConfig config;
+        config.memoryBudget = 0;
+        ePugStation::RewindBuffer rewindBuffer(*machine.cpu, *machine.interconnect, config);
+        for (uint32_t frame = 1; frame <= 8; ++frame)
+        {
+            machine.runFrame(frame);
+            rewindBuffer.onFrame(*machine.cpu, *machine.interconnect);
+        }
+
+        // The newest frame is always kept
+        REQUIRE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+        REQUIRE(rewindBuffer.getFrameCount() == 0);
+        REQUIRE(rewindBuffer.getMemoryUsage() == 0);
+        REQUIRE_FALSE(rewindBuffer.rewind(*machine.cpu, *machine.interconnect));
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include "SaveState.h"
+#include "TestMachine.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // Counts in t1, stores it to RAM and loads it back in a loop
+    const std::vector<uint32_t> COUNTER_LOAD_PROGRAM = {
+        0x3c088000, // lui t0, 0x8000
+        0x24090000, // addiu t1, zero, 0
+        0x25290001, // loop: addiu t1, t1, 1
+        0xad090100, // sw t1, 0x100(t0)
+        0x8d0a0100, // lw t2, 0x100(t0)
+        0x0bf00002, // j loop (0xbfc00008)
+        0x00000000  // nop
+    };
+
+    // Machine running the program above
+    struct Machine : ePugStation::testing::Machine
+    {
+        Machine() : ePugStation::testing::Machine(COUNTER_LOAD_PROGRAM) {}
+    };
+}
+
+TEST_CASE("Save state restores the whole machine")
+{
+    Machine original;
+    original.run(1001);
+    auto state = original.save();
+
+    Machine restored;
+    ePugStation::loadState(*restored.cpu, *restored.interconnect, state.data(), state.size());
+    // Parenthesized, so Catch doesn't stringify megabytes of state
+    REQUIRE((restored.save() == state));
+
+    original.run(500);
+    restored.run(500);
+    REQUIRE((restored.save() == original.save()));
+    REQUIRE(restored.interconnect->load32(0x80000100) == original.interconnect->load32(0x80000100));
+}
+
+TEST_CASE("Delta save state holds only the pages written since the previous snapshot")
+{
+    Machine original;
+    original.run(1001);
+    auto base = original.save();
+
+    original.run(500);
+    original.interconnect->store32(0x80100000, 0x12345678);
+    original.interconnect->store8(0x801ffffc, 0x9a);
+    std::vector<uint8_t> delta;
+    ePugStation::saveDeltaState(*original.cpu, *original.interconnect, delta);
+    REQUIRE(delta.size() < 1024);
+
+    Machine restored;
+    ePugStation::loadState(*restored.cpu, *restored.interconnect, base.data(), base.size());
+    ePugStation::loadState(*restored.cpu, *restored.interconnect, delta.data(), delta.size());
+    REQUIRE((restored.save() == original.save()));
+    REQUIRE(restored.interconnect->load32(0x80100000) == 0x12345678);
+    REQUIRE(restored.interconnect->load8(0x801ffffc) == 0x9a);
+
+    // Nothing written since the last snapshot, only the CPU and registers remain
+    std::vector<uint8_t> empty;
+    ePugStation::saveDeltaState(*restored.cpu, *restored.interconnect, empty);
+    REQUIRE(empty.size() < 1024);
+}
+
+TEST_CASE("Ordering table clear marks the wrapped pages dirty")
+{
+    Machine original;
+    auto base = original.save();
+
+    original.interconnect->store32(0x1f8010e0, 0x000007fc); // D6_MADR, 1024 entries backward from 0x7fc wrap to the end of RAM
+    original.interconnect->store32(0x1f8010e4, 1024);       // D6_BCR
+    original.interconnect->store32(0x1f8010e8, 0x11000002); // D6_CHCR, start
+    std::vector<uint8_t> delta;
+    ePugStation::saveDeltaState(*original.cpu, *original.interconnect, delta);
+
+    Machine restored;
+    ePugStation::loadState(*restored.cpu, *restored.interconnect, base.data(), base.size());
+    ePugStation::loadState(*restored.cpu, *restored.interconnect, delta.data(), delta.size());
+    REQUIRE(restored.interconnect->load32(0x800007fc) == 0x000007f8);
+    REQUIRE(restored.interconnect->load32(0x80000000) == 0x001ffffc);
+    REQUIRE(restored.interconnect->load32(0x801ffffc) == 0x001ffff8);
+    REQUIRE(restored.interconnect->load32(0x801ff800) == 0x00ffffff);
+}
+
+TEST_CASE("Save state rejects foreign and truncated data")
+{
+    Machine machine;
+    auto state = machine.save();
+
+    std::vector<uint8_t> truncated(state.begin(), state.end() - 1);
+    REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, truncated.data(), truncated.size()));
+
+    state[0] ^= 0xff;
+    REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, state.data(), state.size()));
+}
+
+TEST_CASE("Rejected save states leave the machine untouched")
+{
+    Machine source;
+    source.run(1001);
+    auto base = source.save();
+    source.run(500);
+    source.interconnect->store32(0x80100000, 0x12345678);
+    std::vector<uint8_t> delta;
+    ePugStation::saveDeltaState(*source.cpu, *source.interconnect, delta);
+
+    Machine machine;
+    machine.run(10);
+    auto before = machine.save();
+
+    SECTION("Truncated full state")
+    {
+        base.pop_back();
+        REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, base.data(), base.size()));
+    }
+    SECTION("Full state with trailing data")
+    {
+        base.push_back(0);
+        REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, base.data(), base.size()));
+    }
+    SECTION("Truncated delta state")
+    {
+        delta.pop_back();
+        REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, delta.data(), delta.size()));
+    }
+    SECTION("Delta state with an invalid page")
+    {
+        // The headless delta ends with the empty BIOS and VRAM page counts, now 0xffffffff pages from page 0xffffffff
+        std::fill(delta.end() - 8, delta.end(), uint8_t{ 0xff });
+        REQUIRE_THROWS(ePugStation::loadState(*machine.cpu, *machine.interconnect, delta.data(), delta.size()));
+    }
+
+    REQUIRE((machine.save() == before));
+}
@@ -0,0 +1,52 @@
+#ifndef E_PUG_STATION_TEST_MACHINE
+#define E_PUG_STATION_TEST_MACHINE
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "SaveState.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ePugStation::testing
+{
+    // Counts in t1 and stores it to RAM in a loop
+    inline const std::vector<uint32_t> COUNTER_PROGRAM = {
+        0x3c088000, // lui t0, 0x8000
+        0x24090000, // addiu t1, zero, 0
+        0x25290001, // loop: addiu t1, t1, 1
+        0xad090100, // sw t1, 0x100(t0)
+        0x0bf00002, // j loop (0xbfc00008)
+        0x00000000  // nop
+    };
+
+    // Headless CPU and interconnect running "program" from the reset vector
+    struct Machine
+    {
+        explicit Machine(const std::vector<uint32_t>& program = COUNTER_PROGRAM)
+            : interconnect(std::make_unique<Interconnect>(BiosImage::fromWords(program))),
+              cpu(std::make_unique<CPU>(interconnect.get()))
+        {}
+
+        void run(int instructions)
+        {
+            for (int i = 0; i < instructions; ++i)
+            {
+                cpu->runNextInstruction();
+            }
+        }
+
+        std::vector<uint8_t> save() const
+        {
+            std::vector<uint8_t> state;
+            saveState(*cpu, *interconnect, state);
+            return state;
+        }
+
+        std::unique_ptr<Interconnect> interconnect;
+        std::unique_ptr<CPU> cpu;
+    };
+}
+#endif
@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE("Thread pool runs every task before wait returns")
+{
+    ePugStation::ThreadPool pool(4);
+    std::atomic<int> count{ 0 };
+    for (int task = 0; task < 1000; ++task)
+    {
+        pool.submit([&count] { count.fetch_add(1, std::memory_order_relaxed); });
+    }
+    pool.wait();
+
+    REQUIRE(count.load() == 1000);
+}
+
+TEST_CASE("Thread pool waits for the tasks submitted by tasks")
+{
+    ePugStation::ThreadPool pool(3);
+    std::atomic<int> count{ 0 };
+    // Each chain resubmits itself, the way the batch runner splits instances into slices
+    std::function<void(int)> slice = [&](int remaining)
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+        if (remaining > 0)
+        {
+            pool.submit([&slice, remaining] { slice(remaining - 1); });
+        }
+    };
+    for (int chain = 0; chain < 10; ++chain)
+    {
+        pool.submit([&slice] { slice(99); });
+    }
+    pool.wait();
+
+    REQUIRE(count.load() == 1000);
+}
+
+TEST_CASE("Thread pool idle workers steal queued tasks")
+{
+    ePugStation::ThreadPool pool(4);
+    std::atomic<int> count{ 0 };
+    // Submitted from one worker, everything lands in its queue
+    pool.submit([&]
+    {
+        for (int task = 0; task < 64; ++task)
+        {
+            pool.submit([&count]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                count.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+    });
+    pool.wait();
+
+    REQUIRE(count.load() == 64);
+    REQUIRE(pool.getStealCount() > 0);
+}
+
+TEST_CASE("Thread pool rethrows the first task exception from wait")
+{
+    ePugStation::ThreadPool pool(2);
+    pool.submit([] { throw std::runtime_error("task failed"); });
+    REQUIRE_THROWS_AS(pool.wait(), std::runtime_error);
+
+    // Reported once
+    pool.submit([] {});
+    REQUIRE_NOTHROW(pool.wait());
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "Timeline.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // Each test case runs in its own process, one file per case so they can run in parallel
+    std::string saveAndRead(const std::string& fileName)
+    {
+        auto path = std::filesystem::temp_directory_path() / fileName;
+        ePugStation::saveTimeline(path.string());
+        std::ifstream file(path);
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return json;
+    }
+
+    size_t countOccurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+}
+
+TEST_CASE("Timeline records scoped timers as Chrome trace events")
+{
+    {
+        E_PUG_STATION_TIMER("Disabled timer");
+    }
+
+    ePugStation::setTimelineEnabled(true);
+    {
+        E_PUG_STATION_TIMER("Outer timer");
+        E_PUG_STATION_TIMER("Inner timer");
+    }
+    std::thread thread([] {
+        E_PUG_STATION_TIMER("Thread timer");
+    });
+    thread.join();
+    ePugStation::setTimelineEnabled(false);
+
+    auto json = saveAndRead("ePugStationTimelineEvents.json");
+    REQUIRE(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    REQUIRE(countOccurrences(json, "\"name\":\"Outer timer\",\"ph\":\"X\"") == 1);
+    REQUIRE(countOccurrences(json, "\"name\":\"Inner timer\"") == 1);
+    REQUIRE(countOccurrences(json, "\"name\":\"Thread timer\"") == 1);
+    REQUIRE(countOccurrences(json, "Disabled timer") == 0);
+    // Inner timer closes first
+    REQUIRE(json.find("Inner timer") < json.find("Outer timer"));
+}
+
+TEST_CASE("Timeline ring keeps the newest events")
+{
+    ePugStation::setTimelineEnabled(true);
+    std::thread thread([] {
+        for (size_t i = 0; i < ePugStation::TIMELINE_RING_SIZE + 10; ++i)
+        {
+            ePugStation::recordTimelineEvent(i < 10 ? "Overwritten event" : "Kept event", 0, 1);
+        }
+    });
+    thread.join();
+    ePugStation::setTimelineEnabled(false);
+
+    auto json = saveAndRead("ePugStationTimelineRing.json");
+    REQUIRE(countOccurrences(json, "Overwritten event") == 0);
+    // The oldest slot is skipped, it could be the one a running thread is writing
+    REQUIRE(countOccurrences(json, "Kept event") == ePugStation::TIMELINE_RING_SIZE - 1);
+}
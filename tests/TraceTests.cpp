@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+
+#include "BiosImage.h"
+#include "CPU.h"
+#include "Interconnect.h"
+#include "TestMachine.h"
+#include "Trace.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace
+{
+    using ePugStation::testing::COUNTER_PROGRAM;
+
+    // ctest runs the cases in parallel processes, each one passes its own file name
+    std::vector<ePugStation::TraceEntry> runTraced(ePugStation::TraceRecorder& trace, int instructions, const std::string& fileName)
+    {
+        ePugStation::Interconnect interconnect(ePugStation::BiosImage::fromWords(COUNTER_PROGRAM));
+        ePugStation::CPU cpu(&interconnect);
+        for (int i = 0; i < instructions; ++i)
+        {
+            cpu.runNextInstruction<true>(&trace);
+        }
+
+        auto path = std::filesystem::temp_directory_path() / fileName;
+        trace.save(path.string());
+        auto entries = ePugStation::readTrace(path.string());
+        std::filesystem::remove(path);
+        return entries;
+    }
+}
+
+TEST_CASE("Trace records PC, instruction and registers of every instruction")
+{
+    ePugStation::TraceRecorder trace;
+    auto entries = runTraced(trace, 40, "ePugStationTraceRegisters.eptr");
+
+    REQUIRE(entries.size() == 40);
+    REQUIRE(entries[0].index == 0);
+    REQUIRE(entries[0].pc == 0xbfc00000);
+    REQUIRE(entries[0].instruction == 0x3c088000);
+    REQUIRE(entries[0].registers[8] == 0x80000000);
+    REQUIRE(entries[0].registers[ePugStation::TRACE_HI] == 0xdeadbeaf);
+
+    // Loop body : addiu, sw, j, nop, counting one more in t1 each time
+    REQUIRE(entries[6].pc == 0xbfc00008);
+    REQUIRE(entries[6].registers[9] == 2);
+    REQUIRE(entries[5].pc == 0xbfc00014);
+    REQUIRE(entries[39].index == 39);
+}
+
+TEST_CASE("Trace ring keeps the newest chunks")
+{
+    // Smallest chunks, so the ring wraps many times
+    ePugStation::TraceRecorder trace(0, 0);
+    auto entries = runTraced(trace, 5000, "ePugStationTraceRing.eptr");
+
+    REQUIRE(!entries.empty());
+    REQUIRE(entries.size() < 5000);
+    REQUIRE(entries.back().index == 4999);
+    REQUIRE(trace.getRecordCount() == 5000);
+
+    ePugStation::TraceRecorder fullTrace;
+    auto fullEntries = runTraced(fullTrace, 5000, "ePugStationTraceRingFull.eptr");
+    const auto& first = entries.front();
+    const auto& same = fullEntries[first.index];
+    REQUIRE(first.pc == same.pc);
+    REQUIRE(first.registers == same.registers);
+}
+
+TEST_CASE("Trace diff finds the first divergence")
+{
+    ePugStation::TraceRecorder trace;
+    auto entries = runTraced(trace, 100, "ePugStationTraceDiff.eptr");
+    auto other = entries;
+    REQUIRE_FALSE(ePugStation::findFirstDivergence(entries, other));
+
+    other[60].registers[9] ^= 1;
+    other[70].pc ^= 4;
+    REQUIRE(ePugStation::findFirstDivergence(entries, other) == 60u);
+
+    // Aligned on the instruction index when the rings hold different ranges
+    std::vector<ePugStation::TraceEntry> tail(other.begin() + 50, other.end());
+    REQUIRE(ePugStation::findFirstDivergence(entries, tail) == 60u);
+    REQUIRE(ePugStation::findFirstDivergence(tail, entries) == 10u);
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include "TripleBuffer.h"
+
+#include <array>
+#include <thread>
+
+TEST_CASE("Triple buffer hands the newest published value to the consumer")
+{
+    ePugStation::TripleBuffer<int> buffer(0);
+    REQUIRE_FALSE(buffer.update());
+
+    buffer.getWriteBuffer() = 1;
+    buffer.publish();
+    buffer.getWriteBuffer() = 2;
+    buffer.publish();
+
+    REQUIRE(buffer.update());
+    REQUIRE(buffer.getReadBuffer() == 2);
+    REQUIRE_FALSE(buffer.update());
+    REQUIRE(buffer.getReadBuffer() == 2);
+
+    buffer.getWriteBuffer() = 3;
+    buffer.publish();
+    REQUIRE(buffer.update());
+    REQUIRE(buffer.getReadBuffer() == 3);
+}
+
+TEST_CASE("Triple buffer never tears nor goes back in time across threads")
+{
+    // Every element holds the same sequence number, a mix means the consumer saw a partial write
+    using Value = std::array<uint32_t, 64>;
+    constexpr uint32_t VALUE_COUNT = 100000;
+    ePugStation::TripleBuffer<Value> buffer(Value{});
+
+    std::thread producer([&]
+    {
+        for (uint32_t number = 1; number <= VALUE_COUNT; ++number)
+        {
+            buffer.getWriteBuffer().fill(number);
+            buffer.publish();
+        }
+    });
+
+    uint32_t last = 0;
+    bool isTorn = false;
+    bool isBackward = false;
+    while (last != VALUE_COUNT)
+    {
+        if (!buffer.update())
+        {
+            continue;
+        }
+        const Value& value = buffer.getReadBuffer();
+        for (uint32_t element : value)
+        {
+            isTorn |= element != value[0];
+        }
+        isBackward |= value[0] <= last;
+        last = value[0];
+    }
+    producer.join();
+
+    REQUIRE_FALSE(isTorn);
+    REQUIRE_FALSE(isBackward);
+}
@@ -0,0 +1,176 @@
+#include "BiosImage.h"
+#include "CodeCache.h"
+#include "Constants.h"
+#include "Emulator.h"
+#include "PsxExecutable.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace ePugStation;
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string biosPath = PATH_TO_BIOS;
+        std::string exePath;
+        bool isSkippingBios = false;
+        uint32_t instanceCount = 1;
+        uint32_t frameCount = 600;
+        uint32_t sliceFrames = 30;
+        size_t threadCount = std::thread::hardware_concurrency();
+    };
+
+    struct Instance
+    {
+        std::unique_ptr<Emulator> emulator;
+        uint32_t remainingFrames = 0;
+        FrameHashes hashes;
+        Clock::duration busyTime = Clock::duration::zero();
+    };
+
+    // Runs one slice then queues the next one on the same worker, idle workers steal the queued slices
+    void runSlice(ThreadPool& pool, Instance& instance, uint32_t sliceFrames)
+    {
+        auto start = Clock::now();
+        uint32_t frames = std::min(sliceFrames, instance.remainingFrames);
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            instance.emulator->runFrame({});
+        }
+        instance.remainingFrames -= frames;
+        instance.busyTime += Clock::now() - start;
+
+        if (instance.remainingFrames > 0)
+        {
+            pool.submit([&pool, &instance, sliceFrames] { runSlice(pool, instance, sliceFrames); });
+        }
+        else
+        {
+            instance.hashes = instance.emulator->hashFrame();
+        }
+    }
+
+    double toSeconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+// batchRunner [--bios <file>] [--code-cache <dir>] [--exe <file> [--skip-bios]] [--instances <n>] [--frames <n>] [--threads <n>] [--slice <frames>]
+// Boots every instance headless from the same BIOS and runs them side by side. Identical instances
+// must end on identical frames, exits with 1 when they do not.
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--bios" && i + 1 < argc)
+        {
+            options.biosPath = argv[++i];
+        }
+        else if (argument == "--code-cache" && i + 1 < argc)
+        {
+            setCodeCacheDirectory(argv[++i]);
+        }
+        else if (argument == "--exe" && i + 1 < argc)
+        {
+            options.exePath = argv[++i];
+        }
+        else if (argument == "--skip-bios")
+        {
+            options.isSkippingBios = true;
+        }
+        else if (argument == "--instances" && i + 1 < argc)
+        {
+            options.instanceCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--frames" && i + 1 < argc)
+        {
+            options.frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--threads" && i + 1 < argc)
+        {
+            options.threadCount = std::stoul(argv[++i]);
+        }
+        else if (argument == "--slice" && i + 1 < argc)
+        {
+            options.sliceFrames = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else
+        {
+            std::cout << "Usage : batchRunner [--bios <file>] [--code-cache <dir>] [--exe <file> [--skip-bios]] [--instances <n>] [--frames <n>] [--threads <n>] [--slice <frames>]\n";
+            return 2;
+        }
+    }
+
+    try
+    {
+        // One mapping of the BIOS for every instance
+        auto bios = BiosImage::fromFile(options.biosPath);
+        auto executable = options.exePath.empty() ? nullptr : PsxExecutable::fromFile(options.exePath);
+        std::vector<Instance> instances(options.instanceCount);
+        for (Instance& instance : instances)
+        {
+            // Software GPU without a renderer, VRAM is emulated and hashed
+            instance.emulator = std::make_unique<Emulator>(bios, std::make_unique<GPU>());
+            if (executable && options.isSkippingBios)
+            {
+                instance.emulator->loadExecutable(*executable);
+            }
+            else if (executable)
+            {
+                instance.emulator->loadExecutableAfterBoot(executable);
+            }
+            instance.remainingFrames = options.frameCount;
+        }
+
+        ThreadPool pool(options.threadCount);
+        auto start = Clock::now();
+        for (Instance& instance : instances)
+        {
+            pool.submit([&pool, &instance, &options] { runSlice(pool, instance, options.sliceFrames); });
+        }
+        pool.wait();
+        double elapsed = toSeconds(Clock::now() - start);
+
+        bool isMatching = true;
+        for (size_t index = 0; index < instances.size(); ++index)
+        {
+            const Instance& instance = instances[index];
+            isMatching &= instance.hashes == instances.front().hashes;
+            std::printf("%4zu %8llu frames %08x %08x %08x %8.3f s\n", index,
+                        static_cast<unsigned long long>(instance.emulator->getFrameCount()), instance.hashes.ram,
+                        instance.hashes.vram, instance.hashes.display, toSeconds(instance.busyTime));
+        }
+
+        uint64_t totalFrames = static_cast<uint64_t>(options.instanceCount) * options.frameCount;
+        std::printf("%u instances, %llu frames in %.3f s on %zu threads : %.1f frames/s, %llu steals\n",
+                    options.instanceCount, static_cast<unsigned long long>(totalFrames), elapsed, pool.getThreadCount(),
+                    elapsed > 0.0 ? static_cast<double>(totalFrames) / elapsed : 0.0,
+                    static_cast<unsigned long long>(pool.getStealCount()));
+        if (!isMatching)
+        {
+            std::cout << "Instances diverge\n";
+            return 1;
+        }
+        return 0;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << "\n";
+        return 2;
+    }
+}
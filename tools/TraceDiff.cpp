@@ -0,0 +1,81 @@
+#include "Trace.h"
+
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    using namespace ePugStation;
+
+    constexpr size_t CONTEXT_ENTRIES = 8;
+
+    void printEntry(const char* label, const TraceEntry& entry)
+    {
+        std::printf("%s #%llu pc %08x instruction %08x\n", label, static_cast<unsigned long long>(entry.index), entry.pc, entry.instruction);
+    }
+
+    const char* registerName(uint32_t index)
+    {
+        static const char* NAMES[TRACE_REGISTER_COUNT] = {
+            "zero", "at", "v0", "v1", "a0", "a1", "a2", "a3",
+            "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+            "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+            "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra",
+            "hi", "lo"
+        };
+        return NAMES[index];
+    }
+}
+
+// traceDiff <first trace> <second trace>
+// Prints the instructions leading to the first divergence, exits with 1 when there is one
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage : traceDiff <first trace> <second trace>\n";
+        return 2;
+    }
+
+    try
+    {
+        auto first = readTrace(argv[1]);
+        auto second = readTrace(argv[2]);
+        std::cout << argv[1] << " : " << first.size() << " instructions, " << argv[2] << " : " << second.size() << " instructions\n";
+
+        auto divergence = findFirstDivergence(first, second);
+        if (!divergence)
+        {
+            std::cout << "No divergence over the instructions both traces hold\n";
+            return 0;
+        }
+
+        size_t position = *divergence;
+        auto offset = first[position].index - second.front().index;
+        for (size_t i = position - std::min(position, std::min<uint64_t>(offset, CONTEXT_ENTRIES)); i < position; ++i)
+        {
+            printEntry("  ", first[i]);
+        }
+
+        const TraceEntry& a = first[position];
+        const TraceEntry& b = second[offset];
+        std::cout << "First divergence :\n";
+        printEntry("< ", a);
+        printEntry("> ", b);
+        for (uint32_t index = 0; index < TRACE_REGISTER_COUNT; ++index)
+        {
+            if (a.registers[index] != b.registers[index])
+            {
+                std::printf("  %-4s %08x != %08x\n", registerName(index), a.registers[index], b.registers[index]);
+            }
+        }
+        return 1;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << "\n";
+        return 2;
+    }
+}